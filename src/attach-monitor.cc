@@ -0,0 +1,80 @@
+/* attach-monitor.cc
+ *
+ * See attach-monitor.h
+ */
+
+#include "attach-monitor.h"
+
+#include "ns3/log.h"
+#include "ns3/lte-ue-net-device.h"
+#include "ns3/lte-ue-rrc.h"
+#include "ns3/simulator.h"
+
+NS_LOG_COMPONENT_DEFINE("AttachMonitor");
+
+namespace ns3
+{
+
+AttachMonitor::AttachMonitor(const NetDeviceContainer& ueDevices, Callback<void> onAllAttached)
+    : m_ueDevices(ueDevices),
+      m_onAllAttached(onAllAttached),
+      m_complete(false)
+{
+    for (auto it = m_ueDevices.Begin(); it != m_ueDevices.End(); ++it)
+    {
+        Ptr<LteUeNetDevice> ue = DynamicCast<LteUeNetDevice>(*it);
+        NS_ASSERT_MSG(ue, "Not an LteUeNetDevice");
+        ue->GetRrc()->TraceConnectWithoutContext("DrbCreated",
+                                                 MakeCallback(&AttachMonitor::DrbCreated, this));
+    }
+}
+
+AttachMonitor::~AttachMonitor()
+{
+    for (auto it = m_ueDevices.Begin(); it != m_ueDevices.End(); ++it)
+    {
+        // The devices are already disposed if the simulator was destroyed first
+        Ptr<LteUeNetDevice> ue = DynamicCast<LteUeNetDevice>(*it);
+        Ptr<LteUeRrc> rrc = ue ? ue->GetRrc() : nullptr;
+        if (rrc)
+        {
+            rrc->TraceDisconnectWithoutContext("DrbCreated",
+                                               MakeCallback(&AttachMonitor::DrbCreated, this));
+        }
+    }
+}
+
+bool
+AttachMonitor::IsComplete() const
+{
+    return m_complete;
+}
+
+Time
+AttachMonitor::GetCompletionTime() const
+{
+    return m_completionTime;
+}
+
+void
+AttachMonitor::DrbCreated(uint64_t imsi, uint16_t cellId, uint16_t rnti, uint8_t lcid)
+{
+    NS_LOG_FUNCTION(this << imsi << cellId << rnti << +lcid);
+    if (m_complete || !m_attached.insert(imsi).second)
+    {
+        return; // handovers re-create bearers; only the first one counts
+    }
+    if (m_attached.size() == m_ueDevices.GetN())
+    {
+        m_complete = true;
+        m_completionTime = Simulator::Now();
+        NS_LOG_INFO("all " << m_attached.size() << " UEs attached at "
+                           << m_completionTime.As(Time::S));
+        if (!m_onAllAttached.IsNull())
+        {
+            m_onAllAttached();
+        }
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,46 @@
+/* attach-monitor.h
+ *
+ * Detects the end of the attach warm-up: fires a callback once every UE of a container
+ * has its default data radio bearer, i.e. RRC connection, S1 context setup and bearer
+ * establishment are all done.
+ */
+
+#ifndef ATTACH_MONITOR_H
+#define ATTACH_MONITOR_H
+
+#include "ns3/callback.h"
+#include "ns3/net-device-container.h"
+#include "ns3/nstime.h"
+
+#include <set>
+
+namespace ns3
+{
+
+class AttachMonitor
+{
+  public:
+    /**
+     * \param ueDevices LteUeNetDevices to watch
+     * \param onAllAttached invoked once, when the last of them gets its first DRB
+     */
+    AttachMonitor(const NetDeviceContainer& ueDevices, Callback<void> onAllAttached);
+    ~AttachMonitor();
+
+    bool IsComplete() const;
+    /// Simulated time at which the last UE got its bearer (only valid if IsComplete())
+    Time GetCompletionTime() const;
+
+  private:
+    void DrbCreated(uint64_t imsi, uint16_t cellId, uint16_t rnti, uint8_t lcid);
+
+    NetDeviceContainer m_ueDevices;
+    Callback<void> m_onAllAttached;
+    std::set<uint64_t> m_attached; ///< IMSIs that have a DRB
+    bool m_complete;
+    Time m_completionTime;
+};
+
+} // namespace ns3
+
+#endif /* ATTACH_MONITOR_H */
@@ -0,0 +1,248 @@
+/* benchmark-suite.cc
+ *
+ * See benchmark-suite.h
+ */
+
+#include "benchmark-suite.h"
+
+#include "sweep-runner.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+NS_LOG_COMPONENT_DEFINE("BenchmarkSuite");
+
+namespace ns3
+{
+
+/// UEs per eNB when a scale point gives no eNB count; below the 319-UE SRS limit
+static const uint32_t UES_PER_ENB = 250;
+
+BenchmarkSuite::BenchmarkSuite(const std::string& scales,
+                               const std::string& outputDir,
+                               const std::string& flowStatsExtension)
+    : m_outputDir(outputDir),
+      m_flowStatsExtension(flowStatsExtension)
+{
+    std::istringstream in(scales);
+    std::string item;
+    while (std::getline(in, item, ','))
+    {
+        size_t colon = item.find(':');
+        Point point;
+        point.ues = std::stoul(item.substr(0, colon));
+        point.enbs = colon == std::string::npos
+                         ? std::max(4u, (point.ues + UES_PER_ENB - 1) / UES_PER_ENB)
+                         : std::stoul(item.substr(colon + 1));
+        NS_ABORT_MSG_IF(point.ues == 0 || point.enbs == 0, "Bad benchmark scale point " << item);
+        m_points.push_back(point);
+    }
+    NS_ABORT_MSG_IF(m_points.empty(), "--benchmarkScales has no scale point");
+}
+
+std::string
+BenchmarkSuite::Key(uint32_t ues, uint32_t enbs)
+{
+    return std::to_string(ues) + ":" + std::to_string(enbs);
+}
+
+std::map<std::string, BenchmarkSuite::Metrics>
+BenchmarkSuite::ReadJson(const std::string& fileName)
+{
+    std::ifstream in(fileName);
+    NS_ABORT_MSG_UNLESS(in.is_open(), "Cannot open benchmark baseline " << fileName);
+    std::map<std::string, Metrics> points;
+    std::string line;
+    while (std::getline(in, line))
+    {
+        // Only the one-line point objects written by Run() carry numeric fields
+        Metrics metrics;
+        size_t pos = 0;
+        while ((pos = line.find('"', pos)) != std::string::npos)
+        {
+            size_t end = line.find('"', pos + 1);
+            if (end == std::string::npos)
+            {
+                break;
+            }
+            std::string name = line.substr(pos + 1, end - pos - 1);
+            size_t colon = line.find_first_not_of(" \t", end + 1);
+            pos = end + 1;
+            if (colon == std::string::npos || line[colon] != ':')
+            {
+                continue;
+            }
+            std::istringstream value(line.substr(colon + 1));
+            double v;
+            if (value >> v)
+            {
+                metrics[name] = v;
+            }
+        }
+        if (metrics.count("ues") && metrics.count("enbs"))
+        {
+            uint32_t ues = metrics["ues"];
+            uint32_t enbs = metrics["enbs"];
+            points[Key(ues, enbs)] = metrics;
+        }
+    }
+    return points;
+}
+
+int
+BenchmarkSuite::Run(ScenarioFunction scenario,
+                    int argc,
+                    char* argv[],
+                    const std::string& jsonFile,
+                    const std::string& baselineFile,
+                    double threshold)
+{
+    if (mkdir(m_outputDir.c_str(), 0755) != 0 && errno != EEXIST)
+    {
+        NS_FATAL_ERROR("Cannot create benchmark directory " << m_outputDir << ": "
+                                                             << std::strerror(errno));
+    }
+
+    const std::set<std::string> perPoint =
+        {"numUes", "numEnbs", "RngRun", "runSummaryFile", "flowStatsFile"};
+    std::vector<std::string> common;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        std::string name = arg.substr(0, arg.find('='));
+        name.erase(0, name.find_first_not_of('-'));
+        if (name.rfind("benchmark", 0) == 0 || perPoint.count(name))
+        {
+            continue;
+        }
+        common.push_back(arg);
+    }
+
+    bool failed = false;
+    std::vector<Metrics> results;
+    for (const Point& point : m_points)
+    {
+        std::string tag = m_outputDir + "/ues" + std::to_string(point.ues) + "-enbs" +
+                          std::to_string(point.enbs);
+        std::string summaryFile = tag + "-summary.txt";
+        std::vector<std::string> args = common;
+        args.push_back("--numUes=" + std::to_string(point.ues));
+        args.push_back("--numEnbs=" + std::to_string(point.enbs));
+        args.push_back("--RngRun=1");
+        args.push_back("--runSummaryFile=" + summaryFile);
+        args.push_back("--flowStatsFile=" + tag + "-flowmon." + m_flowStatsExtension);
+        std::vector<char*> childArgv;
+        childArgv.push_back(argv[0]);
+        for (std::string& a : args)
+        {
+            childArgv.push_back(&a[0]);
+        }
+        childArgv.push_back(nullptr);
+
+        // Flushed before fork(), or the child would print it again
+        std::cout << "benchmark: " << point.ues << " UEs, " << point.enbs << " eNBs"
+                  << std::endl;
+        auto start = std::chrono::steady_clock::now();
+        pid_t pid = fork();
+        NS_ABORT_MSG_IF(pid < 0, "fork() failed: " << std::strerror(errno));
+        if (pid == 0)
+        {
+            int status = scenario(childArgv.size() - 1, childArgv.data());
+            std::cout.flush();
+            std::cerr.flush();
+            _exit(status);
+        }
+        int status = 0;
+        struct rusage usage;
+        while (wait4(pid, &status, 0, &usage) < 0)
+        {
+            NS_ABORT_MSG_IF(errno != EINTR, "wait4() failed: " << std::strerror(errno));
+        }
+        double wallTime =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        {
+            std::cerr << "benchmark: point " << Key(point.ues, point.enbs) << " failed"
+                      << std::endl;
+            failed = true;
+            continue;
+        }
+
+        SweepRunner::Kpis kpis = SweepRunner::ReadRunSummary(summaryFile);
+        Metrics metrics;
+        metrics["ues"] = point.ues;
+        metrics["enbs"] = point.enbs;
+        metrics["wall_time_s"] = wallTime;
+        metrics["events"] = kpis["events"];
+        metrics["events_per_s"] = kpis["events"] / wallTime;
+        metrics["peak_rss_mb"] = usage.ru_maxrss / 1024.0; // KiB on Linux
+        metrics["sim_s_per_wall_s"] = kpis["sim_time_s"] / wallTime;
+        results.push_back(metrics);
+    }
+
+    std::ofstream out(jsonFile);
+    NS_ABORT_MSG_UNLESS(out.is_open(), "Cannot open benchmark output " << jsonFile);
+    out << "{\n  \"seed_run\": 1,\n  \"points\": [\n";
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const Metrics& m = results[i];
+        out << std::setprecision(10) << "    {\"ues\": " << m.at("ues")
+            << ", \"enbs\": " << m.at("enbs") << ", \"wall_time_s\": " << m.at("wall_time_s")
+            << ", \"events\": " << m.at("events") << ", \"events_per_s\": " << m.at("events_per_s")
+            << ", \"peak_rss_mb\": " << m.at("peak_rss_mb")
+            << ", \"sim_s_per_wall_s\": " << m.at("sim_s_per_wall_s") << "}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+    out.close();
+    std::cout << "benchmark: results written to " << jsonFile << std::endl;
+
+    if (!baselineFile.empty())
+    {
+        std::map<std::string, Metrics> baseline = ReadJson(baselineFile);
+        for (const Metrics& m : results)
+        {
+            auto it = baseline.find(
+                Key(static_cast<uint32_t>(m.at("ues")), static_cast<uint32_t>(m.at("enbs"))));
+            if (it == baseline.end())
+            {
+                continue;
+            }
+            for (const std::string& name : {"wall_time_s", "peak_rss_mb"})
+            {
+                double base = it->second[name];
+                double change = base > 0 ? m.at(name) / base - 1.0 : 0.0;
+                bool regressed = change > threshold;
+                failed = failed || regressed;
+                std::cout << "benchmark: " << it->first << " " << name << " " << m.at(name)
+                          << " vs " << base << " (" << std::showpos << 100.0 * change
+                          << std::noshowpos << "%)" << (regressed ? " REGRESSION" : "")
+                          << std::endl;
+            }
+            if (it->second["events"] != m.at("events"))
+            {
+                // Not a performance regression, but the runs are no longer comparable
+                std::cout << "benchmark: " << it->first << " event count changed ("
+                          << m.at("events") << " vs " << it->second["events"] << ")"
+                          << std::endl;
+            }
+        }
+    }
+    return failed ? 1 : 0;
+}
+
+} // namespace ns3
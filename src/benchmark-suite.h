@@ -0,0 +1,79 @@
+/* benchmark-suite.h
+ *
+ * Reproducible performance benchmark of the scenario at several scales (--benchmarkSuite).
+ *
+ * Each scale point (UEs, eNBs) runs the scenario once with RngRun 1, in a forked child
+ * that calls the scenario function directly, so every point starts from the same fresh
+ * process state and the points run strictly one after another. The suite records per
+ * point the wall time, the simulator events and events per wall second, the child's
+ * peak RSS and the simulated seconds per wall second, and writes them to a JSON file
+ * (one point per line). Given a baseline file of the same format, every point found in
+ * both is compared and the suite fails if its wall time or peak RSS grew by more than
+ * the threshold.
+ */
+
+#ifndef BENCHMARK_SUITE_H
+#define BENCHMARK_SUITE_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+class BenchmarkSuite
+{
+  public:
+    /// The scenario entry point; returns the process exit status
+    using ScenarioFunction = int (*)(int argc, char* argv[]);
+
+    /**
+     * \param scales ','-separated "ues:enbs" points, e.g. "10:4,100:4,1000:4,5000:20";
+     *        without ":enbs" one eNB per 250 UEs (at least 4) is used
+     * \param outputDir directory for the per-point summary and flow statistics files
+     * \param flowStatsExtension extension of the per-point flow statistics file
+     */
+    BenchmarkSuite(const std::string& scales,
+                   const std::string& outputDir,
+                   const std::string& flowStatsExtension);
+
+    /**
+     * Run every point and write \p jsonFile.
+     *
+     * Every argument of \p argv except the --benchmark* options, --numUes, --numEnbs,
+     * --RngRun and the output files is passed unchanged to each point.
+     *
+     * \param baselineFile JSON file of an earlier run to compare with (empty = none)
+     * \param threshold relative wall time / peak RSS growth that fails the suite
+     * \return 0 if every point ran and none regressed, 1 otherwise
+     */
+    int Run(ScenarioFunction scenario,
+            int argc,
+            char* argv[],
+            const std::string& jsonFile,
+            const std::string& baselineFile,
+            double threshold);
+
+  private:
+    struct Point
+    {
+        uint32_t ues;
+        uint32_t enbs;
+    };
+    /// Metric name -> value of one point
+    using Metrics = std::map<std::string, double>;
+
+    /// Metrics of every point of a JSON file written by Run(), keyed by "ues:enbs"
+    static std::map<std::string, Metrics> ReadJson(const std::string& fileName);
+    static std::string Key(uint32_t ues, uint32_t enbs);
+
+    std::vector<Point> m_points;
+    std::string m_outputDir;
+    std::string m_flowStatsExtension;
+};
+
+} // namespace ns3
+
+#endif /* BENCHMARK_SUITE_H */
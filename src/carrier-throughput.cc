@@ -0,0 +1,121 @@
+/* carrier-throughput.cc
+ *
+ * See carrier-throughput.h
+ */
+
+#include "carrier-throughput.h"
+
+#include "ns3/abort.h"
+#include "ns3/component-carrier-enb.h"
+#include "ns3/log.h"
+#include "ns3/lte-enb-mac.h"
+#include "ns3/lte-enb-net-device.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+
+NS_LOG_COMPONENT_DEFINE("CarrierThroughput");
+
+namespace ns3
+{
+
+CarrierThroughput::CarrierThroughput(const NetDeviceContainer& enbDevices)
+    : m_start(Simulator::Now())
+{
+    for (uint32_t i = 0; i < enbDevices.GetN(); ++i)
+    {
+        Ptr<LteEnbNetDevice> enb = DynamicCast<LteEnbNetDevice>(enbDevices.Get(i));
+        for (const auto& cc : enb->GetCcMap())
+        {
+            Ptr<ComponentCarrierEnb> carrier = DynamicCast<ComponentCarrierEnb>(cc.second);
+            uint32_t index = m_carriers.size();
+            m_carriers.push_back({i,
+                                  carrier->GetCellId(),
+                                  cc.first,
+                                  carrier->GetDlEarfcn(),
+                                  carrier->GetDlBandwidth(),
+                                  carrier->GetUlBandwidth()});
+            carrier->GetMac()->TraceConnectWithoutContext(
+                "DlScheduling",
+                MakeBoundCallback(&CarrierThroughput::DlScheduling, this, index));
+            carrier->GetMac()->TraceConnectWithoutContext(
+                "UlScheduling",
+                MakeBoundCallback(&CarrierThroughput::UlScheduling, this, index));
+        }
+    }
+}
+
+double
+CarrierThroughput::Elapsed() const
+{
+    return std::max((Simulator::Now() - m_start).GetSeconds(), 1e-9);
+}
+
+void
+CarrierThroughput::Write(const std::string& fileName) const
+{
+    std::ofstream out(fileName);
+    NS_ABORT_MSG_UNLESS(out.is_open(), "Cannot open carrier statistics file " << fileName);
+    out << "enb,cell_id,carrier,dl_earfcn,dl_bandwidth_rb,ul_bandwidth_rb,dl_bytes,ul_bytes,"
+           "dl_throughput_mbps,ul_throughput_mbps\n";
+    const double seconds = Elapsed();
+    for (const Carrier& c : m_carriers)
+    {
+        out << c.enb << "," << c.cellId << "," << static_cast<uint32_t>(c.componentCarrierId)
+            << "," << c.dlEarfcn << "," << c.dlBandwidth << "," << c.ulBandwidth << ","
+            << c.dlBytes << "," << c.ulBytes << "," << c.dlBytes * 8.0 / seconds / 1e6 << ","
+            << c.ulBytes * 8.0 / seconds / 1e6 << "\n";
+    }
+}
+
+void
+CarrierThroughput::AddKpis(SweepRunner::Kpis& kpis) const
+{
+    std::map<uint8_t, std::pair<uint64_t, uint64_t>> perIndex; // dl, ul bytes
+    uint64_t dlBytes = 0;
+    uint64_t ulBytes = 0;
+    for (const Carrier& c : m_carriers)
+    {
+        perIndex[c.componentCarrierId].first += c.dlBytes;
+        perIndex[c.componentCarrierId].second += c.ulBytes;
+        dlBytes += c.dlBytes;
+        ulBytes += c.ulBytes;
+    }
+    const double seconds = Elapsed();
+    kpis["mac_dl_throughput_mbps"] = dlBytes * 8.0 / seconds / 1e6;
+    kpis["mac_ul_throughput_mbps"] = ulBytes * 8.0 / seconds / 1e6;
+    if (perIndex.size() > 1)
+    {
+        for (const auto& cc : perIndex)
+        {
+            std::string prefix = "cc" + std::to_string(cc.first);
+            kpis[prefix + "_mac_dl_throughput_mbps"] = cc.second.first * 8.0 / seconds / 1e6;
+            kpis[prefix + "_mac_ul_throughput_mbps"] = cc.second.second * 8.0 / seconds / 1e6;
+        }
+    }
+}
+
+void
+CarrierThroughput::DlScheduling(CarrierThroughput* self,
+                                uint32_t carrier,
+                                DlSchedulingCallbackInfo info)
+{
+    self->m_carriers[carrier].dlBytes += info.sizeTb1 + info.sizeTb2;
+}
+
+void
+CarrierThroughput::UlScheduling(CarrierThroughput* self,
+                                uint32_t carrier,
+                                uint32_t /* frameNo */,
+                                uint32_t /* subframeNo */,
+                                uint16_t /* rnti */,
+                                uint8_t /* mcs */,
+                                uint16_t tbSize,
+                                uint8_t /* componentCarrierId */)
+{
+    self->m_carriers[carrier].ulBytes += tbSize;
+}
+
+} // namespace ns3
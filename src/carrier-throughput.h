@@ -0,0 +1,71 @@
+/* carrier-throughput.h
+ *
+ * MAC-scheduled throughput per eNB component carrier (--carrierStatsFile).
+ *
+ * Every component carrier of every eNB has its own LteEnbMac; its DlScheduling and
+ * UlScheduling traces report each transport block handed out (new data and HARQ
+ * retransmissions alike). The bytes are summed per carrier from construction until
+ * Write(), together with the carrier's EARFCN and bandwidth, so a run with more
+ * carriers per eNB can be compared with one with more eNBs at the same spectrum.
+ */
+
+#ifndef CARRIER_THROUGHPUT_H
+#define CARRIER_THROUGHPUT_H
+
+#include "sweep-runner.h"
+
+#include "ns3/lte-common.h"
+#include "ns3/net-device-container.h"
+#include "ns3/nstime.h"
+
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+class CarrierThroughput
+{
+  public:
+    /// \param enbDevices LteEnbNetDevices whose carriers are measured
+    explicit CarrierThroughput(const NetDeviceContainer& enbDevices);
+
+    /// One CSV row per eNB and carrier, throughput over the time since construction
+    void Write(const std::string& fileName) const;
+    /// Add the total and per-carrier-index downlink / uplink throughput to \p kpis
+    void AddKpis(SweepRunner::Kpis& kpis) const;
+
+  private:
+    struct Carrier
+    {
+        uint32_t enb;
+        uint16_t cellId;
+        uint8_t componentCarrierId;
+        uint32_t dlEarfcn;
+        uint16_t dlBandwidth;
+        uint16_t ulBandwidth;
+        uint64_t dlBytes = 0;
+        uint64_t ulBytes = 0;
+    };
+
+    static void DlScheduling(CarrierThroughput* self,
+                             uint32_t carrier,
+                             DlSchedulingCallbackInfo info);
+    static void UlScheduling(CarrierThroughput* self,
+                             uint32_t carrier,
+                             uint32_t frameNo,
+                             uint32_t subframeNo,
+                             uint16_t rnti,
+                             uint8_t mcs,
+                             uint16_t tbSize,
+                             uint8_t componentCarrierId);
+    /// Seconds since construction
+    double Elapsed() const;
+
+    std::vector<Carrier> m_carriers;
+    Time m_start;
+};
+
+} // namespace ns3
+
+#endif /* CARRIER_THROUGHPUT_H */
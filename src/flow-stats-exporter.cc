@@ -0,0 +1,226 @@
+/* flow-stats-exporter.cc
+ *
+ * See flow-stats-exporter.h
+ */
+
+#include "flow-stats-exporter.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+NS_LOG_COMPONENT_DEFINE("FlowStatsExporter");
+
+namespace ns3
+{
+
+namespace
+{
+
+template <typename T>
+void
+WriteRaw(std::ofstream& out, const T& value)
+{
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+void
+WriteColumn(std::ofstream& out, const std::vector<T>& column)
+{
+    out.write(reinterpret_cast<const char*>(column.data()), column.size() * sizeof(T));
+}
+
+} // namespace
+
+FlowStatsExporter::FlowStatsExporter(Ptr<FlowMonitor> monitor,
+                                     Ptr<Ipv4FlowClassifier> classifier,
+                                     const std::string& fileName,
+                                     Format format,
+                                     Time interval)
+    : m_monitor(monitor),
+      m_classifier(classifier),
+      m_format(format),
+      m_interval(interval),
+      m_lastExport(Seconds(0))
+{
+    NS_ABORT_MSG_IF(m_interval <= Seconds(0), "Flow stats export interval must be positive");
+
+    m_out.open(fileName, format == BINARY ? std::ios::out | std::ios::binary : std::ios::out);
+    NS_ABORT_MSG_UNLESS(m_out.is_open(), "Cannot open flow stats file " << fileName);
+
+    if (m_format == BINARY)
+    {
+        m_out.write("LTEFLOW1", 8);
+        WriteRaw<uint32_t>(m_out, 1); // version
+        WriteRaw<uint32_t>(m_out, 0); // reserved
+    }
+    else
+    {
+        m_out << "time_s,flow_id,src,dst,src_port,dst_port,protocol,"
+                 "tx_bytes,rx_bytes,tx_packets,rx_packets,lost_packets,"
+                 "delay_sum_s,jitter_sum_s,interval_throughput_mbps\n";
+    }
+}
+
+FlowStatsExporter::~FlowStatsExporter()
+{
+    Simulator::Cancel(m_event);
+}
+
+FlowStatsExporter::Format
+FlowStatsExporter::ParseFormat(const std::string& name)
+{
+    if (name == "csv")
+    {
+        return CSV;
+    }
+    if (name == "binary")
+    {
+        return BINARY;
+    }
+    NS_FATAL_ERROR("Unknown flow stats format " << name << " (expected csv or binary)");
+    return CSV;
+}
+
+void
+FlowStatsExporter::Start()
+{
+    m_lastExport = Simulator::Now();
+    m_event = Simulator::Schedule(m_interval, &FlowStatsExporter::PeriodicExport, this);
+}
+
+void
+FlowStatsExporter::Finish()
+{
+    Simulator::Cancel(m_event);
+    Export();
+    m_out.close();
+}
+
+void
+FlowStatsExporter::PeriodicExport()
+{
+    Export();
+    m_event = Simulator::Schedule(m_interval, &FlowStatsExporter::PeriodicExport, this);
+}
+
+void
+FlowStatsExporter::Export()
+{
+    // Also drops packets older than MaxPerHopDelay from the monitor's tracking maps,
+    // which is what keeps FlowMonitor's own memory bounded on long runs
+    m_monitor->CheckForLostPackets();
+    const FlowMonitor::FlowStatsContainer& stats = m_monitor->GetFlowStats();
+
+    NS_LOG_DEBUG("Exporting " << stats.size() << " flows at " << Simulator::Now().As(Time::S));
+    if (m_format == BINARY)
+    {
+        WriteBinary(stats, Simulator::Now().GetNanoSeconds());
+    }
+    else
+    {
+        WriteCsv(stats, Simulator::Now().GetSeconds());
+    }
+    m_lastExport = Simulator::Now();
+}
+
+void
+FlowStatsExporter::WriteCsv(const FlowMonitor::FlowStatsContainer& stats, double now)
+{
+    double elapsed = (Simulator::Now() - m_lastExport).GetSeconds();
+
+    for (const auto& entry : stats)
+    {
+        const FlowMonitor::FlowStats& fs = entry.second;
+        Ipv4FlowClassifier::FiveTuple t = m_classifier->FindFlow(entry.first);
+
+        uint64_t& lastRx = m_lastRxBytes[entry.first];
+        double mbps = elapsed > 0 ? (fs.rxBytes - lastRx) * 8.0 / elapsed / 1e6 : 0.0;
+        lastRx = fs.rxBytes;
+
+        m_out << now << ',' << entry.first << ',' << t.sourceAddress << ','
+              << t.destinationAddress << ',' << t.sourcePort << ',' << t.destinationPort << ','
+              << static_cast<uint32_t>(t.protocol) << ',' << fs.txBytes << ',' << fs.rxBytes
+              << ',' << fs.txPackets << ',' << fs.rxPackets << ',' << fs.lostPackets << ','
+              << fs.delaySum.GetSeconds() << ',' << fs.jitterSum.GetSeconds() << ',' << mbps
+              << '\n';
+    }
+}
+
+void
+FlowStatsExporter::WriteBinary(const FlowMonitor::FlowStatsContainer& stats, int64_t nowNs)
+{
+    // Describe the flows that appeared since the previous snapshot
+    std::vector<FlowId> newFlows;
+    for (const auto& entry : stats)
+    {
+        if (m_lastRxBytes.emplace(entry.first, entry.second.rxBytes).second)
+        {
+            newFlows.push_back(entry.first);
+        }
+        else
+        {
+            m_lastRxBytes[entry.first] = entry.second.rxBytes;
+        }
+    }
+    if (!newFlows.empty())
+    {
+        WriteRaw<uint32_t>(m_out, BLOCK_FLOWS);
+        WriteRaw<uint32_t>(m_out, newFlows.size());
+        for (FlowId id : newFlows)
+        {
+            Ipv4FlowClassifier::FiveTuple t = m_classifier->FindFlow(id);
+            WriteRaw<uint32_t>(m_out, id);
+            WriteRaw<uint32_t>(m_out, t.sourceAddress.Get());
+            WriteRaw<uint32_t>(m_out, t.destinationAddress.Get());
+            WriteRaw<uint16_t>(m_out, t.sourcePort);
+            WriteRaw<uint16_t>(m_out, t.destinationPort);
+            WriteRaw<uint32_t>(m_out, t.protocol);
+        }
+    }
+
+    const size_t n = stats.size();
+    std::vector<uint32_t> flowId;
+    std::vector<uint64_t> txBytes;
+    std::vector<uint64_t> rxBytes;
+    std::vector<uint32_t> txPackets;
+    std::vector<uint32_t> rxPackets;
+    std::vector<uint32_t> lostPackets;
+    std::vector<int64_t> delaySumNs;
+    std::vector<int64_t> jitterSumNs;
+    flowId.reserve(n);
+    txBytes.reserve(n);
+    rxBytes.reserve(n);
+    txPackets.reserve(n);
+    rxPackets.reserve(n);
+    lostPackets.reserve(n);
+    delaySumNs.reserve(n);
+    jitterSumNs.reserve(n);
+    for (const auto& entry : stats)
+    {
+        const FlowMonitor::FlowStats& fs = entry.second;
+        flowId.push_back(entry.first);
+        txBytes.push_back(fs.txBytes);
+        rxBytes.push_back(fs.rxBytes);
+        txPackets.push_back(fs.txPackets);
+        rxPackets.push_back(fs.rxPackets);
+        lostPackets.push_back(fs.lostPackets);
+        delaySumNs.push_back(fs.delaySum.GetNanoSeconds());
+        jitterSumNs.push_back(fs.jitterSum.GetNanoSeconds());
+    }
+
+    WriteRaw<uint32_t>(m_out, BLOCK_SNAPSHOT);
+    WriteRaw<uint32_t>(m_out, n);
+    WriteRaw<int64_t>(m_out, nowNs);
+    WriteColumn(m_out, flowId);
+    WriteColumn(m_out, txBytes);
+    WriteColumn(m_out, rxBytes);
+    WriteColumn(m_out, txPackets);
+    WriteColumn(m_out, rxPackets);
+    WriteColumn(m_out, lostPackets);
+    WriteColumn(m_out, delaySumNs);
+    WriteColumn(m_out, jitterSumNs);
+}
+
+} // namespace ns3
@@ -0,0 +1,90 @@
+/* flow-stats-exporter.h
+ *
+ * Periodic, bounded-memory export of FlowMonitor per-flow counters.
+ *
+ * Instead of one SerializeToXmlFile() at the end of the run, the exporter wakes up every
+ * interval, purges FlowMonitor's in-flight packet tracking (CheckForLostPackets) and
+ * appends one row per flow to the output file. Nothing but the previous rx byte count of
+ * each flow is kept between intervals, so memory does not grow with simulated time.
+ *
+ * Formats:
+ *  - csv:    one text row per flow per interval
+ *  - binary: a "LTEFLOW1" file header followed by blocks; a FLOWS block describes each
+ *            flow's five-tuple the first time it is seen and a SNAPSHOT block stores the
+ *            counters of all flows as one column per counter. All values are written in
+ *            host byte order.
+ */
+
+#ifndef FLOW_STATS_EXPORTER_H
+#define FLOW_STATS_EXPORTER_H
+
+#include "ns3/event-id.h"
+#include "ns3/flow-monitor.h"
+#include "ns3/ipv4-flow-classifier.h"
+#include "ns3/nstime.h"
+
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+class FlowStatsExporter
+{
+  public:
+    enum Format
+    {
+        CSV,
+        BINARY
+    };
+
+    /// Binary block types
+    enum BlockType : uint32_t
+    {
+        BLOCK_FLOWS = 1,
+        BLOCK_SNAPSHOT = 2
+    };
+
+    /**
+     * \param monitor the flow monitor to read
+     * \param classifier classifier of \p monitor, used to describe new flows
+     * \param fileName output file
+     * \param format CSV or BINARY
+     * \param interval simulated time between two exports
+     */
+    FlowStatsExporter(Ptr<FlowMonitor> monitor,
+                      Ptr<Ipv4FlowClassifier> classifier,
+                      const std::string& fileName,
+                      Format format,
+                      Time interval);
+    ~FlowStatsExporter();
+
+    /// Schedule the first periodic export
+    void Start();
+    /// Write the final snapshot and close the file; call after Simulator::Run()
+    void Finish();
+
+    /// Parse "csv" or "binary"; aborts on anything else
+    static Format ParseFormat(const std::string& name);
+
+  private:
+    void PeriodicExport();
+    void Export();
+    void WriteCsv(const FlowMonitor::FlowStatsContainer& stats, double now);
+    void WriteBinary(const FlowMonitor::FlowStatsContainer& stats, int64_t nowNs);
+
+    Ptr<FlowMonitor> m_monitor;
+    Ptr<Ipv4FlowClassifier> m_classifier;
+    std::ofstream m_out;
+    Format m_format;
+    Time m_interval;
+    EventId m_event;
+    Time m_lastExport;
+    std::unordered_map<FlowId, uint64_t> m_lastRxBytes; ///< rx bytes at the previous export
+};
+
+} // namespace ns3
+
+#endif /* FLOW_STATS_EXPORTER_H */
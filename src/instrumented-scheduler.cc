@@ -0,0 +1,140 @@
+/* instrumented-scheduler.cc
+ *
+ * See instrumented-scheduler.h
+ */
+
+#include "instrumented-scheduler.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/map-scheduler.h"
+#include "ns3/object-factory.h"
+
+#include <algorithm>
+#include <chrono>
+
+NS_LOG_COMPONENT_DEFINE("InstrumentedScheduler");
+
+namespace ns3
+{
+
+NS_OBJECT_ENSURE_REGISTERED(InstrumentedScheduler);
+
+namespace
+{
+
+InstrumentedScheduler::Stats g_stats;
+
+/// Adds the lifetime of the object to g_stats.queueNs
+class QueueTimer
+{
+  public:
+    QueueTimer()
+        : m_start(std::chrono::steady_clock::now())
+    {
+    }
+
+    ~QueueTimer()
+    {
+        g_stats.queueNs += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                               std::chrono::steady_clock::now() - m_start)
+                               .count();
+    }
+
+  private:
+    std::chrono::steady_clock::time_point m_start;
+};
+
+} // namespace
+
+TypeId
+InstrumentedScheduler::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::InstrumentedScheduler")
+            .SetParent<Scheduler>()
+            .AddConstructor<InstrumentedScheduler>()
+            .AddAttribute("SchedulerType",
+                          "Event queue backend the calls are forwarded to",
+                          TypeIdValue(MapScheduler::GetTypeId()),
+                          MakeTypeIdAccessor(&InstrumentedScheduler::SetSchedulerType,
+                                             &InstrumentedScheduler::GetSchedulerType),
+                          MakeTypeIdChecker());
+    return tid;
+}
+
+InstrumentedScheduler::InstrumentedScheduler()
+{
+}
+
+InstrumentedScheduler::~InstrumentedScheduler()
+{
+}
+
+void
+InstrumentedScheduler::SetSchedulerType(TypeId type)
+{
+    NS_ABORT_MSG_UNLESS(!m_scheduler || m_scheduler->IsEmpty(),
+                        "SchedulerType cannot change while events are queued");
+    ObjectFactory factory;
+    factory.SetTypeId(type);
+    m_scheduler = factory.Create<Scheduler>();
+    m_schedulerType = type;
+}
+
+TypeId
+InstrumentedScheduler::GetSchedulerType() const
+{
+    return m_schedulerType;
+}
+
+void
+InstrumentedScheduler::Insert(const Event& ev)
+{
+    {
+        QueueTimer timer;
+        m_scheduler->Insert(ev);
+    }
+    ++g_stats.inserts;
+    g_stats.peakSize = std::max(g_stats.peakSize, ++g_stats.size);
+}
+
+bool
+InstrumentedScheduler::IsEmpty() const
+{
+    return m_scheduler->IsEmpty();
+}
+
+Scheduler::Event
+InstrumentedScheduler::PeekNext() const
+{
+    QueueTimer timer;
+    return m_scheduler->PeekNext();
+}
+
+Scheduler::Event
+InstrumentedScheduler::RemoveNext()
+{
+    g_stats.sizeSum += g_stats.size;
+    ++g_stats.removeNexts;
+    --g_stats.size;
+    QueueTimer timer;
+    return m_scheduler->RemoveNext();
+}
+
+void
+InstrumentedScheduler::Remove(const Event& ev)
+{
+    ++g_stats.removes;
+    --g_stats.size;
+    QueueTimer timer;
+    m_scheduler->Remove(ev);
+}
+
+const InstrumentedScheduler::Stats&
+InstrumentedScheduler::GetStats()
+{
+    return g_stats;
+}
+
+} // namespace ns3
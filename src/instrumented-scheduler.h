@@ -0,0 +1,64 @@
+/* instrumented-scheduler.h
+ *
+ * Event-queue decorator that counts and times the work of the backend it wraps.
+ *
+ * Installed instead of the --eventQueue backend under --profile: every Insert,
+ * PeekNext, RemoveNext and Remove is forwarded to a SchedulerType instance and timed,
+ * and the queue length is tracked, so the profile can show how large the event set gets
+ * at a given scale and how much of the run the chosen backend costs. The simulator owns
+ * its single scheduler, so the statistics are kept per process and read with GetStats().
+ * The two clock reads per call add a few tens of ns per event; compare backends with
+ * each other under --profile, not against unprofiled runs.
+ */
+
+#ifndef INSTRUMENTED_SCHEDULER_H
+#define INSTRUMENTED_SCHEDULER_H
+
+#include "ns3/ptr.h"
+#include "ns3/scheduler.h"
+#include "ns3/type-id.h"
+
+#include <cstdint>
+
+namespace ns3
+{
+
+class InstrumentedScheduler : public Scheduler
+{
+  public:
+    struct Stats
+    {
+        uint64_t inserts = 0;
+        uint64_t removeNexts = 0;
+        uint64_t removes = 0;       ///< Simulator::Remove(), not cancellations
+        uint64_t size = 0;          ///< events queued now
+        uint64_t peakSize = 0;
+        double sizeSum = 0;         ///< queue length summed over RemoveNext() calls
+        uint64_t queueNs = 0;       ///< wall time spent in the wrapped backend
+    };
+
+    static TypeId GetTypeId();
+
+    InstrumentedScheduler();
+    ~InstrumentedScheduler() override;
+
+    void Insert(const Event& ev) override;
+    bool IsEmpty() const override;
+    Event PeekNext() const override;
+    Event RemoveNext() override;
+    void Remove(const Event& ev) override;
+
+    /// Statistics of this process's instrumented scheduler
+    static const Stats& GetStats();
+
+  private:
+    void SetSchedulerType(TypeId type);
+    TypeId GetSchedulerType() const;
+
+    TypeId m_schedulerType;
+    Ptr<Scheduler> m_scheduler;
+};
+
+} // namespace ns3
+
+#endif /* INSTRUMENTED_SCHEDULER_H */
@@ -0,0 +1,318 @@
+/* kpi-aggregator.cc
+ *
+ * See kpi-aggregator.h
+ */
+
+#include "kpi-aggregator.h"
+
+#include "ns3/abort.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/log.h"
+#include "ns3/lte-enb-net-device.h"
+#include "ns3/lte-ue-net-device.h"
+#include "ns3/lte-ue-rrc.h"
+#include "ns3/node.h"
+#include "ns3/simulator.h"
+#include "ns3/tag.h"
+#include "ns3/tcp-header.h"
+#include "ns3/tcp-l4-protocol.h"
+#include "ns3/udp-header.h"
+#include "ns3/udp-l4-protocol.h"
+
+#include <algorithm>
+
+NS_LOG_COMPONENT_DEFINE("KpiAggregator");
+
+namespace ns3
+{
+
+/// Send time of a downlink packet, added by KpiAggregator at the remote host
+class KpiTimestampTag : public Tag
+{
+  public:
+    static TypeId GetTypeId()
+    {
+        static TypeId tid = TypeId("ns3::KpiTimestampTag")
+                                .SetParent<Tag>()
+                                .AddConstructor<KpiTimestampTag>();
+        return tid;
+    }
+
+    TypeId GetInstanceTypeId() const override
+    {
+        return GetTypeId();
+    }
+
+    uint32_t GetSerializedSize() const override
+    {
+        return sizeof(int64_t);
+    }
+
+    void Serialize(TagBuffer i) const override
+    {
+        i.WriteU64(m_sent);
+    }
+
+    void Deserialize(TagBuffer i) override
+    {
+        m_sent = i.ReadU64();
+    }
+
+    void Print(std::ostream& os) const override
+    {
+        os << "sent=" << m_sent;
+    }
+
+    int64_t m_sent = 0; ///< ns
+};
+
+NS_OBJECT_ENSURE_REGISTERED(KpiTimestampTag);
+
+KpiAggregator::KpiAggregator(const NodeContainer& remoteHosts,
+                             const NetDeviceContainer& ueDevices,
+                             const NetDeviceContainer& enbDevices,
+                             const std::map<uint16_t, std::string>& classes,
+                             const std::string& fileName,
+                             Time window,
+                             uint32_t slices)
+    : m_ueDevices(ueDevices),
+      m_numEnbs(enbDevices.GetN()),
+      m_current(0),
+      m_closed(0),
+      m_window(window),
+      m_sliceLength(window / slices)
+{
+    NS_ABORT_MSG_IF(window <= Seconds(0) || slices == 0,
+                    "KPI window and slice count must be positive");
+
+    for (const auto& c : classes)
+    {
+        m_classOfPort[c.first] = m_classes.size();
+        m_classes.push_back(c.second);
+    }
+    m_classKpis.resize(m_classes.size());
+    m_slices.resize(m_classes.size() * (m_numEnbs + 1), std::vector<Slice>(slices));
+
+    for (uint32_t i = 0; i < enbDevices.GetN(); ++i)
+    {
+        m_enbOfCell[DynamicCast<LteEnbNetDevice>(enbDevices.Get(i))->GetCellId()] = i;
+    }
+    for (uint32_t i = 0; i < ueDevices.GetN(); ++i)
+    {
+        Ptr<Node> node = ueDevices.Get(i)->GetNode();
+        Ptr<Ipv4L3Protocol> ipv4 = node->GetObject<Ipv4L3Protocol>();
+        int32_t interface = ipv4->GetInterfaceForDevice(ueDevices.Get(i));
+        NS_ABORT_MSG_IF(interface < 0, "UE " << i << " has no IPv4 address yet");
+        m_ueOfAddress[ipv4->GetAddress(interface, 0).GetLocal().Get()] = i;
+        ipv4->TraceConnectWithoutContext("LocalDeliver",
+                                         MakeBoundCallback(&KpiAggregator::Deliver, this, i));
+    }
+    for (auto it = remoteHosts.Begin(); it != remoteHosts.End(); ++it)
+    {
+        (*it)->GetObject<Ipv4L3Protocol>()->TraceConnectWithoutContext(
+            "SendOutgoing",
+            MakeCallback(&KpiAggregator::Send, this));
+    }
+
+    m_out.open(fileName);
+    NS_ABORT_MSG_UNLESS(m_out.is_open(), "Cannot open KPI window file " << fileName);
+    m_out << "time_s,class,enb,rx_packets,throughput_mbps,delay_p50_ms,delay_p95_ms,"
+             "delay_p99_ms,loss_ratio\n";
+}
+
+KpiAggregator::~KpiAggregator()
+{
+    Simulator::Cancel(m_event);
+}
+
+void
+KpiAggregator::Start()
+{
+    m_event = Simulator::Schedule(m_sliceLength, &KpiAggregator::CloseSlice, this);
+}
+
+void
+KpiAggregator::Finish()
+{
+    Simulator::Cancel(m_event);
+    m_out.close();
+}
+
+void
+KpiAggregator::SetWindowCallback(Callback<void> callback)
+{
+    m_onWindow = callback;
+}
+
+const std::vector<std::string>&
+KpiAggregator::GetClasses() const
+{
+    return m_classes;
+}
+
+KpiAggregator::WindowKpis
+KpiAggregator::GetClassKpis(uint32_t classIndex) const
+{
+    return m_classKpis[classIndex];
+}
+
+int
+KpiAggregator::ClassOf(const Ipv4Header& header, Ptr<const Packet> packet) const
+{
+    uint16_t port = 0;
+    if (header.GetProtocol() == UdpL4Protocol::PROT_NUMBER)
+    {
+        UdpHeader udp;
+        packet->PeekHeader(udp);
+        port = udp.GetDestinationPort();
+    }
+    else if (header.GetProtocol() == TcpL4Protocol::PROT_NUMBER)
+    {
+        TcpHeader tcp;
+        packet->PeekHeader(tcp);
+        port = tcp.GetDestinationPort();
+    }
+    auto it = m_classOfPort.find(port);
+    return it == m_classOfPort.end() ? -1 : static_cast<int>(it->second);
+}
+
+uint32_t
+KpiAggregator::ServingEnb(uint32_t ue) const
+{
+    uint16_t cellId = DynamicCast<LteUeNetDevice>(m_ueDevices.Get(ue))->GetRrc()->GetCellId();
+    auto it = m_enbOfCell.find(cellId);
+    return it == m_enbOfCell.end() ? m_numEnbs : it->second;
+}
+
+KpiAggregator::Slice&
+KpiAggregator::CurrentSlice(uint32_t classIndex, uint32_t enb)
+{
+    return m_slices[classIndex * (m_numEnbs + 1) + enb][m_current];
+}
+
+void
+KpiAggregator::Send(const Ipv4Header& header, Ptr<const Packet> packet, uint32_t /* interface */)
+{
+    auto ue = m_ueOfAddress.find(header.GetDestination().Get());
+    if (ue == m_ueOfAddress.end())
+    {
+        return;
+    }
+    int classIndex = ClassOf(header, packet);
+    if (classIndex < 0)
+    {
+        return;
+    }
+    KpiTimestampTag tag;
+    tag.m_sent = Simulator::Now().GetNanoSeconds();
+    packet->AddByteTag(tag);
+
+    uint32_t enb = ServingEnb(ue->second);
+    if (enb < m_numEnbs)
+    {
+        ++CurrentSlice(classIndex, enb).txPackets;
+    }
+    ++CurrentSlice(classIndex, m_numEnbs).txPackets;
+}
+
+void
+KpiAggregator::Deliver(KpiAggregator* self,
+                       uint32_t ue,
+                       const Ipv4Header& header,
+                       Ptr<const Packet> packet,
+                       uint32_t /* interface */)
+{
+    int classIndex = self->ClassOf(header, packet);
+    if (classIndex < 0)
+    {
+        return;
+    }
+    KpiTimestampTag tag;
+    bool stamped = packet->FindFirstMatchingByteTag(tag);
+    double delay = (Simulator::Now().GetNanoSeconds() - tag.m_sent) * 1e-9;
+
+    uint32_t enb = self->ServingEnb(ue);
+    auto record = [&](Slice& slice) {
+        ++slice.rxPackets;
+        slice.rxBytes += packet->GetSize();
+        if (stamped)
+        {
+            slice.delay.Add(delay);
+        }
+    };
+    if (enb < self->m_numEnbs)
+    {
+        record(self->CurrentSlice(classIndex, enb));
+    }
+    record(self->CurrentSlice(classIndex, self->m_numEnbs));
+}
+
+KpiAggregator::WindowKpis
+KpiAggregator::Summarize(uint32_t key) const
+{
+    const std::vector<Slice>& ring = m_slices[key];
+    uint64_t txPackets = 0;
+    uint64_t rxBytes = 0;
+    WindowKpis kpis;
+    LogBucketSketch delay;
+    for (const Slice& slice : ring)
+    {
+        txPackets += slice.txPackets;
+        kpis.rxPackets += slice.rxPackets;
+        rxBytes += slice.rxBytes;
+        delay.Merge(slice.delay);
+    }
+    kpis.throughputMbps = rxBytes * 8.0 / (m_sliceLength.GetSeconds() * m_closed) / 1e6;
+    kpis.delayP50Ms = 1e3 * delay.GetQuantile(0.50);
+    kpis.delayP95Ms = 1e3 * delay.GetQuantile(0.95);
+    kpis.delayP99Ms = 1e3 * delay.GetQuantile(0.99);
+    kpis.lossRatio =
+        txPackets ? std::max(0.0, 1.0 - static_cast<double>(kpis.rxPackets) / txPackets) : 0.0;
+    return kpis;
+}
+
+void
+KpiAggregator::CloseSlice()
+{
+    const uint32_t numSlices = m_slices.front().size();
+    m_closed = std::min(m_closed + 1, numSlices);
+
+    double now = Simulator::Now().GetSeconds();
+    for (uint32_t key = 0; key < m_slices.size(); ++key)
+    {
+        uint32_t classIndex = key / (m_numEnbs + 1);
+        uint32_t enb = key % (m_numEnbs + 1);
+        WindowKpis kpis = Summarize(key);
+        if (enb == m_numEnbs)
+        {
+            m_classKpis[classIndex] = kpis;
+        }
+        if (kpis.rxPackets == 0 && kpis.lossRatio == 0)
+        {
+            continue;
+        }
+        m_out << now << "," << m_classes[classIndex] << ","
+              << (enb == m_numEnbs ? std::string("all") : std::to_string(enb)) << ","
+              << kpis.rxPackets << "," << kpis.throughputMbps << "," << kpis.delayP50Ms << ","
+              << kpis.delayP95Ms << "," << kpis.delayP99Ms << "," << kpis.lossRatio << "\n";
+    }
+
+    // Recycle the oldest slice for the next step
+    m_current = (m_current + 1) % numSlices;
+    for (std::vector<Slice>& ring : m_slices)
+    {
+        Slice& slice = ring[m_current];
+        slice.txPackets = 0;
+        slice.rxPackets = 0;
+        slice.rxBytes = 0;
+        slice.delay.Clear();
+    }
+
+    m_event = Simulator::Schedule(m_sliceLength, &KpiAggregator::CloseSlice, this);
+    if (!m_onWindow.IsNull())
+    {
+        m_onWindow();
+    }
+}
+
+} // namespace ns3
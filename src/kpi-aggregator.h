@@ -0,0 +1,132 @@
+/* kpi-aggregator.h
+ *
+ * In-simulation sliding-window KPIs per traffic class and eNB (--kpiWindow).
+ *
+ * Downlink packets are stamped with a byte tag when the remote hosts' IPv4 layer sends
+ * them and read back when a UE's IPv4 layer delivers them locally; the destination port
+ * selects the traffic class and the UE's serving cell at that moment the eNB. Each
+ * (class, eNB) key, plus one "all eNBs" key per class, keeps a ring of Slices; a slice
+ * holds tx/rx packet counts, rx bytes and a LogBucketSketch of the one-way delays. Every
+ * window / slices of simulated time the oldest slice is recycled and one CSV row per
+ * active key is written with the throughput, the delay p50/p95/p99 and the loss ratio
+ * over the slices of the last window. Memory is fixed per key; nothing grows with the
+ * number of packets or with simulated time.
+ *
+ * Loss is 1 - rx / tx over the window, so packets still in flight at its edges count as
+ * lost for one step. Packets that never crossed a remote host (--bulkModel=saturated)
+ * count towards throughput but have neither delay nor tx count.
+ */
+
+#ifndef KPI_AGGREGATOR_H
+#define KPI_AGGREGATOR_H
+
+#include "log-bucket-sketch.h"
+
+#include "ns3/callback.h"
+#include "ns3/event-id.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/net-device-container.h"
+#include "ns3/node-container.h"
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+
+#include <fstream>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+class KpiAggregator
+{
+  public:
+    /// KPIs of one key over the last window
+    struct WindowKpis
+    {
+        uint64_t rxPackets = 0;
+        double throughputMbps = 0;
+        double delayP50Ms = 0;
+        double delayP95Ms = 0;
+        double delayP99Ms = 0;
+        double lossRatio = 0;
+    };
+
+    /**
+     * \param remoteHosts nodes whose outgoing packets are stamped
+     * \param ueDevices LteUeNetDevices whose nodes' deliveries are measured
+     * \param enbDevices LteEnbNetDevices, to map serving cells to eNB indices
+     * \param classes destination port -> class name
+     * \param fileName CSV output file
+     * \param window sliding window length
+     * \param slices sub-windows per window; a row is written every window / slices
+     */
+    KpiAggregator(const NodeContainer& remoteHosts,
+                  const NetDeviceContainer& ueDevices,
+                  const NetDeviceContainer& enbDevices,
+                  const std::map<uint16_t, std::string>& classes,
+                  const std::string& fileName,
+                  Time window,
+                  uint32_t slices);
+    ~KpiAggregator();
+
+    /// Schedule the first slice boundary
+    void Start();
+    /// Stop the periodic output and close the file
+    void Finish();
+
+    /// Invoked after each window's rows have been written
+    void SetWindowCallback(Callback<void> callback);
+
+    /// Class names, in the order of GetClassKpis() indices
+    const std::vector<std::string>& GetClasses() const;
+    /// KPIs of class \p classIndex over all eNBs, for the last completed window
+    WindowKpis GetClassKpis(uint32_t classIndex) const;
+
+  private:
+    struct Slice
+    {
+        uint64_t txPackets = 0;
+        uint64_t rxPackets = 0;
+        uint64_t rxBytes = 0;
+        LogBucketSketch delay;
+    };
+
+    void Send(const Ipv4Header& header, Ptr<const Packet> packet, uint32_t interface);
+    static void Deliver(KpiAggregator* self,
+                        uint32_t ue,
+                        const Ipv4Header& header,
+                        Ptr<const Packet> packet,
+                        uint32_t interface);
+    /// Class index of a packet, or -1 if its destination port is not a class
+    int ClassOf(const Ipv4Header& header, Ptr<const Packet> packet) const;
+    /// eNB index serving \p ue, or the number of eNBs if it has no cell
+    uint32_t ServingEnb(uint32_t ue) const;
+    Slice& CurrentSlice(uint32_t classIndex, uint32_t enb);
+    WindowKpis Summarize(uint32_t key) const;
+    void CloseSlice();
+
+    NetDeviceContainer m_ueDevices;
+    std::unordered_map<uint16_t, uint32_t> m_enbOfCell;
+    std::unordered_map<uint32_t, uint32_t> m_ueOfAddress; ///< UE IPv4 address -> index
+    std::unordered_map<uint16_t, uint32_t> m_classOfPort;
+    std::vector<std::string> m_classes;
+    uint32_t m_numEnbs;
+
+    /// m_slices[key][slice], key = class * (numEnbs + 1) + eNB, eNB numEnbs = all eNBs
+    std::vector<std::vector<Slice>> m_slices;
+    uint32_t m_current; ///< slice being filled
+    uint32_t m_closed;  ///< slices completed so far, capped at the ring size
+    std::vector<WindowKpis> m_classKpis;
+
+    std::ofstream m_out;
+    Time m_window;
+    Time m_sliceLength;
+    EventId m_event;
+    Callback<void> m_onWindow;
+};
+
+} // namespace ns3
+
+#endif /* KPI_AGGREGATOR_H */
@@ -0,0 +1,200 @@
+/* kpi-sampler.cc
+ *
+ * See kpi-sampler.h
+ */
+
+#include "kpi-sampler.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/lte-enb-net-device.h"
+#include "ns3/lte-ue-net-device.h"
+#include "ns3/lte-ue-phy.h"
+#include "ns3/lte-ue-rrc.h"
+#include "ns3/node.h"
+#include "ns3/simulator.h"
+
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+NS_LOG_COMPONENT_DEFINE("KpiSampler");
+
+namespace ns3
+{
+
+KpiSampler::KpiSampler(const NetDeviceContainer& ueDevices,
+                       const NetDeviceContainer& enbDevices,
+                       const ApplicationContainer& sinks,
+                       const std::string& fileName,
+                       Time interval,
+                       size_t ringCapacity)
+    : m_ueDevices(ueDevices),
+      m_sinkOfUe(ueDevices.GetN()),
+      m_lastRx(ueDevices.GetN(), 0),
+      m_rsrpDbm(ueDevices.GetN(), std::numeric_limits<double>::quiet_NaN()),
+      m_sinrDb(ueDevices.GetN(), std::numeric_limits<double>::quiet_NaN()),
+      m_enbServed(enbDevices.GetN(), 0),
+      m_enbThroughput(enbDevices.GetN(), 0.0),
+      m_interval(interval),
+      m_ring(ringCapacity),
+      m_running(false),
+      m_dropped(0)
+{
+    NS_ABORT_MSG_IF(m_interval <= Seconds(0), "KPI sampling interval must be positive");
+
+    m_out.open(fileName);
+    NS_ABORT_MSG_UNLESS(m_out.is_open(), "Cannot open KPI file " << fileName);
+    m_out << "time_s,kind,id,cell_id,served_ues,throughput_mbps,rsrp_dbm,sinr_db\n";
+
+    for (uint32_t i = 0; i < enbDevices.GetN(); ++i)
+    {
+        m_enbIndexByCellId[DynamicCast<LteEnbNetDevice>(enbDevices.Get(i))->GetCellId()] = i;
+    }
+
+    std::map<uint32_t, uint32_t> ueIndexByNodeId;
+    for (uint32_t i = 0; i < m_ueDevices.GetN(); ++i)
+    {
+        ueIndexByNodeId[m_ueDevices.Get(i)->GetNode()->GetId()] = i;
+
+        // Only the value current at the sampling instant is kept
+        Ptr<LteUePhy> phy = DynamicCast<LteUeNetDevice>(m_ueDevices.Get(i))->GetPhy();
+        phy->TraceConnect("ReportCurrentCellRsrpSinr",
+                          std::to_string(i),
+                          MakeCallback(&KpiSampler::RsrpSinr, this));
+    }
+    for (auto it = sinks.Begin(); it != sinks.End(); ++it)
+    {
+        auto ue = ueIndexByNodeId.find((*it)->GetNode()->GetId());
+        Ptr<PacketSink> sink = DynamicCast<PacketSink>(*it);
+        if (ue != ueIndexByNodeId.end() && sink)
+        {
+            m_sinkOfUe[ue->second] = sink;
+        }
+    }
+}
+
+KpiSampler::~KpiSampler()
+{
+    Stop();
+}
+
+void
+KpiSampler::Start()
+{
+    NS_ABORT_MSG_IF(m_running, "KpiSampler already started");
+    m_running = true;
+    m_writer = std::thread(&KpiSampler::WriterLoop, this);
+    m_event = Simulator::Schedule(m_interval, &KpiSampler::Sample, this);
+}
+
+void
+KpiSampler::Stop()
+{
+    Simulator::Cancel(m_event);
+    if (m_writer.joinable())
+    {
+        m_running = false;
+        m_writer.join();
+        NS_LOG_INFO("KPI sampler dropped " << m_dropped << " records");
+    }
+}
+
+uint64_t
+KpiSampler::GetDropped() const
+{
+    return m_dropped;
+}
+
+void
+KpiSampler::RsrpSinr(std::string context,
+                     uint16_t /* cellId */,
+                     uint16_t /* rnti */,
+                     double rsrp,
+                     double sinr,
+                     uint8_t /* componentCarrierId */)
+{
+    uint32_t ue = std::stoul(context);
+    // The PHY reports linear values: RSRP in W, SINR as a ratio
+    m_rsrpDbm[ue] = 10.0 * std::log10(rsrp) + 30.0;
+    m_sinrDb[ue] = 10.0 * std::log10(sinr);
+}
+
+void
+KpiSampler::Sample()
+{
+    double now = Simulator::Now().GetSeconds();
+    double seconds = m_interval.GetSeconds();
+    std::fill(m_enbServed.begin(), m_enbServed.end(), 0);
+    std::fill(m_enbThroughput.begin(), m_enbThroughput.end(), 0.0);
+
+    for (uint32_t i = 0; i < m_ueDevices.GetN(); ++i)
+    {
+        double mbps = 0;
+        if (m_sinkOfUe[i])
+        {
+            uint64_t rx = m_sinkOfUe[i]->GetTotalRx();
+            mbps = (rx - m_lastRx[i]) * 8.0 / seconds / 1e6;
+            m_lastRx[i] = rx;
+        }
+
+        Ptr<LteUeRrc> rrc = DynamicCast<LteUeNetDevice>(m_ueDevices.Get(i))->GetRrc();
+        uint16_t cellId = rrc->GetState() == LteUeRrc::CONNECTED_NORMALLY ? rrc->GetCellId() : 0;
+        auto enb = m_enbIndexByCellId.find(cellId);
+        if (enb != m_enbIndexByCellId.end())
+        {
+            ++m_enbServed[enb->second];
+            m_enbThroughput[enb->second] += mbps;
+        }
+
+        Push({now, i, cellId, UE, 0, mbps, m_rsrpDbm[i], m_sinrDb[i]});
+    }
+
+    for (const auto& enb : m_enbIndexByCellId)
+    {
+        uint32_t i = enb.second;
+        double nan = std::numeric_limits<double>::quiet_NaN();
+        Push({now, i, enb.first, ENB, m_enbServed[i], m_enbThroughput[i], nan, nan});
+    }
+
+    m_event = Simulator::Schedule(m_interval, &KpiSampler::Sample, this);
+}
+
+void
+KpiSampler::Push(const Record& record)
+{
+    if (!m_ring.TryPush(record))
+    {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void
+KpiSampler::WriterLoop()
+{
+    Record r;
+    while (true)
+    {
+        // Read the flag before draining: once it is false, nothing more gets pushed
+        bool running = m_running.load(std::memory_order_acquire);
+        bool any = false;
+        while (m_ring.TryPop(r))
+        {
+            any = true;
+            m_out << r.timeSeconds << ',' << (r.kind == UE ? "ue" : "enb") << ',' << r.id
+                  << ',' << r.cellId << ',' << r.servedUes << ',' << r.throughputMbps << ','
+                  << r.rsrpDbm << ',' << r.sinrDb << '\n';
+        }
+        if (!running)
+        {
+            break;
+        }
+        if (!any)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    m_out.close();
+}
+
+} // namespace ns3
@@ -0,0 +1,107 @@
+/* log-bucket-sketch.h
+ *
+ * Fixed-size, mergeable quantile sketch for positive values (delays in seconds).
+ *
+ * Values are counted in logarithmic buckets: bucket i holds [MIN_VALUE * g^(i-1),
+ * MIN_VALUE * g^i) with g = (1 + a) / (1 - a), so every quantile is returned with a
+ * relative error of at most a = 1% over 1 us .. 770 s (values outside are clamped to the
+ * first / last bucket). The memory is NUM_BUCKETS counters whatever the number of
+ * values, and two sketches merge by adding their counters, which is what the sliding
+ * windows of KpiAggregator are built from.
+ */
+
+#ifndef LOG_BUCKET_SKETCH_H
+#define LOG_BUCKET_SKETCH_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+namespace ns3
+{
+
+class LogBucketSketch
+{
+  public:
+    static constexpr double MIN_VALUE = 1e-6;
+    static constexpr double RELATIVE_ACCURACY = 0.01;
+    static constexpr uint32_t NUM_BUCKETS = 1024;
+
+    LogBucketSketch()
+        : m_total(0)
+    {
+        m_counts.fill(0);
+    }
+
+    void Add(double value)
+    {
+        ++m_counts[BucketOf(value)];
+        ++m_total;
+    }
+
+    void Merge(const LogBucketSketch& other)
+    {
+        for (uint32_t i = 0; i < NUM_BUCKETS; ++i)
+        {
+            m_counts[i] += other.m_counts[i];
+        }
+        m_total += other.m_total;
+    }
+
+    void Clear()
+    {
+        m_counts.fill(0);
+        m_total = 0;
+    }
+
+    uint64_t GetCount() const
+    {
+        return m_total;
+    }
+
+    /// Value at quantile \p q in [0, 1]; 0 if the sketch is empty
+    double GetQuantile(double q) const
+    {
+        if (m_total == 0)
+        {
+            return 0.0;
+        }
+        uint64_t rank = std::llround(std::clamp(q, 0.0, 1.0) * (m_total - 1));
+        uint64_t seen = 0;
+        for (uint32_t i = 0; i < NUM_BUCKETS; ++i)
+        {
+            seen += m_counts[i];
+            if (seen > rank)
+            {
+                // Point of the bucket with relative error a to both of its ends
+                return MIN_VALUE * std::pow(Gamma(), i) * 2.0 / (Gamma() + 1.0);
+            }
+        }
+        return MIN_VALUE * std::pow(Gamma(), NUM_BUCKETS - 1);
+    }
+
+  private:
+    static double Gamma()
+    {
+        return (1.0 + RELATIVE_ACCURACY) / (1.0 - RELATIVE_ACCURACY);
+    }
+
+    static uint32_t BucketOf(double value)
+    {
+        static const double logGamma = std::log(Gamma());
+        if (value <= MIN_VALUE)
+        {
+            return 0;
+        }
+        double index = std::ceil(std::log(value / MIN_VALUE) / logGamma);
+        return std::min<double>(index, NUM_BUCKETS - 1);
+    }
+
+    std::array<uint32_t, NUM_BUCKETS> m_counts;
+    uint64_t m_total;
+};
+
+} // namespace ns3
+
+#endif /* LOG_BUCKET_SKETCH_H */
@@ -3,20 +3,97 @@
  * Fully compatible with ns-3.39
  *
  * Requirements implemented:
- *  - 4 eNBs
- *  - 10 UEs
+ *  - 4 eNBs (--numEnbs), placed on a grid or hexagonal layout (--siteLayout) over
+ *    an --areaSize x --areaSize square
+ *  - 10 UEs (--numUes): first half RandomWalk2d, second half waypoint (car-like);
+ *    --mobilityModel=population moves all of them with one batched structure-of-arrays
+ *    update per --mobilityStep instead of per-UE mobility objects and events
+ *  - --vehicleTrace drives the waypoint UEs from a SUMO FCD or ns-2 mobility file, memory
+ *    mapped and streamed into waypoints --vehicleLookahead seconds ahead of simulated time
  *  - 2 remote hosts:
  *      - remoteHosts.Get(0) -> generates BulkSend/TCP traffic to a subset of UEs
+ *        (--bulkModel=saturated replaces it by a full-buffer source feeding the eNB RLC
+ *        directly, without TCP/IP or EPC tunnelling)
  *      - remoteHosts.Get(1) -> generates OnOff/UDP ("web-like") traffic to another subset of UEs
+ *        (--webModel=session replaces it by web sessions: pages of main + embedded objects
+ *        separated by reading times, each object sent as packet trains; with
+ *        --webActivation=ondemand sink and sender only exist during Poisson-arriving
+ *        sessions of --sessionDuration, so most UEs have no application at all)
+ *  - --pathlossModel selects the LTE path-loss model; --interferenceCutoff drops eNB/UE
+ *    pairs beyond that distance from the per-TTI channel and SINR work, and
+ *    --pathlossCacheThreshold reuses pair losses until an end moves that far
+ *  - --remCache=<dir> tabulates each eNB's path-loss field over the area once, stores it
+ *    as memory-mapped tiles keyed by site, grid and model, and serves links by bilinear
+ *    lookup in this and every later run of the layout
+ *  - --routing=trie swaps list + static routing on the UEs, remote hosts and PGW for a
+ *    longest-prefix-match trie, with the UE default routes set when the stack is installed
+ *  - --handover=a3-rsrp|a2-a4 adds X2 between all eNBs and a handover algorithm;
+ *    --attachMode=auto lets each UE pick its initial cell; UE measurements are filtered
+ *    over --measurementPeriod and reports gated by --handoverTtt / --handoverHysteresis
+ *  - --dlBandwidth / --ulBandwidth / --dlEarfcn / --ulEarfcn set each eNB's carrier and
+ *    --numCarriers > 1 enables carrier aggregation (round-robin component carrier manager,
+ *    carriers placed contiguously from the EARFCN); --carrierStatsFile writes the
+ *    MAC-scheduled throughput of every eNB carrier, and the run summary gets the totals
+ *  - --scheduler selects the eNB MAC scheduler (PF, RR, TD-MT, PSS, CQA);
+ *    --schedulerBench drives the schedulers' downlink allocation with synthetic CQI and
+ *    full-buffer reports for --schedulerBenchUes UEs, outside any simulation, and prints
+ *    their scheduling decisions per second (PF-array: the contiguous-array PF kernel)
+ *  - --selfTest=all runs the consistency checks of the scenario's own components
+ *    (self-test.h) instead of simulating
  *  - EPC + PGW configured correctly
  *  - correct IPv4 addressing for remote-host links (avoids collisions with EPC 7.0.0.0/8)
  *  - UE IPs assigned using the PointToPointEpcHelper API for ns-3.39
  *  - default routes on UEs and static routes on remote hosts so traffic flows via PGW
- *  - FlowMonitor enabled and result serialized to flowmon-lte.xml
+ *  - a single FlowMonitor (probes on all nodes, or only on UEs / remote hosts / PGW via
+ *    --flowmonScope, which then only sees the flows sent by those nodes and prints a
+ *    warning saying so); per-flow rows are streamed every --flowStatsInterval to
+ *    flowmon-lte.csv (or a binary columnar file), --flowStatsFormat=xml keeps the old
+ *    end-of-run flowmon-lte.xml
+ *  - --profile prints wall time / events / RSS per scenario phase and the events/s rate
+ *    sampled over simulated time during Simulator::Run()
+ *  - --eventQueue=map|heap|calendar|list picks the ns-3 event queue, tti a bucketed
+ *    calendar queue with one bucket per 1 ms TTI; under --profile the queue is
+ *    instrumented and the profile adds its length and the wall time spent in it
+ *  - --sweep runs a parameter grid x RngRun replications as parallel child processes and
+ *    merges their KPIs into one table with 95% confidence intervals, e.g.
+ *    --sweep="numUes=10,100;webRate=1Mbps,5Mbps;walkSpeed=1,5;runs=1-10"; each run writes
+ *    its output files to --sweepDir, and --progress is not available
+ *  - --kpiInterval samples per-UE throughput / RSRP / SINR and per-eNB load into a
+ *    lock-free ring buffer drained to kpi-lte.csv by a background writer thread
+ *  - --progress publishes simulated time, real-time factor, ETA, event rate, RSS and UE
+ *    throughput every --progressPeriod wall seconds from a background thread, to stderr,
+ *    a UNIX socket (JSON lines) or a Prometheus text endpoint
+ *  - --kpiWindow writes sliding-window throughput, delay p50/p95/p99 (fixed-size log-bucket
+ *    sketches) and loss per traffic class and eNB to kpi-windows.csv during the run
+ *  - --steadyStateTolerance stops the run early once every class's windowed throughput and
+ *    median delay have converged (MSER truncation + batch-means 95% interval); --simTime
+ *    stays the upper bound
+ *  - --traceLayers=phy,mac,rlc,pdcp hooks only the selected layers of --traceUes /
+ *    --traceEnbs and writes per-window aggregates to a compact binary lte-traces.bin
+ *    instead of the per-TTI LteHelper text traces
+ *  - --packetPool replaces the global operator new / delete by thread-local size-class
+ *    free lists over one reserved region, so the packets, buffers, tags and events of the
+ *    data path are recycled instead of going through malloc
+ *  - --benchmarkSuite runs the scenario with RngRun 1 at each --benchmarkScales point
+ *    (10 / 100 / 1000 / 5000 UEs by default) and writes wall time, events/s, peak RSS and
+ *    simulated seconds per wall second to --benchmarkFile; with --benchmarkBaseline it
+ *    fails if a point's wall time or RSS grew by more than --benchmarkThreshold
+ *  - --snapshotReplications=N simulates the attach warm-up once, then forks N processes
+ *    from that in-memory state, each continuing with its own RngRun and writing every
+ *    output file as <name>-repN.<extension>
+ *  - --warmup=fast runs the attach first and installs the applications once every UE has
+ *    its bearer, so traffic starts right after the attach instead of at the fixed 0.5-2 s
+ *    start times (the sinks / sources keep their relative offsets)
+ *  - --distributed (ns-3 built with --enable-mpi, run under mpirun -np 2) puts the remote
+ *    hosts on rank 1 and the EPC core + radio side on rank 0; the 2 ms remote-host/PGW
+ *    point-to-point links are the only cross-rank channels and set the lookahead. Rank 1
+ *    installs no LTE devices or UE mobility on its ghost nodes, so it only runs the
+ *    remote hosts' TCP/IP and applications
  *
- * Save into: ns-3.39/scratch/lte-simulation-ns339.cc
+ * Save into: ns-3.39/scratch/lte-simulation/ (copy every file of src/, ns-3 builds all
+ *            .cc files of a scratch subdirectory into one program)
  * Build: from ns-3.39 directory run: cmake .. ; make -j4  (or use the existing build configuration)
- * Run:  from ns-3.39/build (or ns-3.39 root depending your setup) ./ns3 run "scratch/lte-simulation-ns339"
+ * Run:  from ns-3.39/build (or ns-3.39 root depending your setup) ./ns3 run "lte-simulation"
  */
 
 #include "ns3/core-module.h"
@@ -27,22 +104,801 @@
 #include "ns3/applications-module.h"
 #include "ns3/point-to-point-module.h"
 #include "ns3/flow-monitor-module.h"
+#ifdef NS3_MPI
+#include "ns3/mpi-interface.h"
+#endif
+
+#include "attach-monitor.h"
+#include "benchmark-suite.h"
+#include "carrier-throughput.h"
+#include "flow-stats-exporter.h"
+#include "instrumented-scheduler.h"
+#include "kpi-aggregator.h"
+#include "kpi-sampler.h"
+#include "lte-trace-collector.h"
+#include "mac-scheduler-bench.h"
+#include "pooled-allocator.h"
+#include "progress-reporter.h"
+#include "population-mobility.h"
+#include "rem-cache-loss-model.h"
+#include "saturated-source.h"
+#include "scenario-profiler.h"
+#include "self-test.h"
+#include "session-traffic-manager.h"
+#include "spatial-cutoff-loss-model.h"
+#include "steady-state-detector.h"
+#include "sweep-runner.h"
+#include "trajectory-streamer.h"
+#include "trie-ipv4-routing.h"
+#include "web-session-application.h"
 
 using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE("LteProjectSimulation_ns339");
 
-int
-main(int argc, char *argv[])
+/**
+ * Build the eNB site positions for the requested layout.
+ *
+ * "grid" spreads the sites row by row over the square, so 4 sites on a 200 m area
+ * are the original (0,0) (200,0) (0,200) (200,200) corners. "hex" shifts every other
+ * row by half a site spacing and packs rows at sqrt(3)/2 of it.
+ */
+static Ptr<ListPositionAllocator>
+CreateSitePositions(uint32_t numEnbs, double areaSize, const std::string& layout)
+{
+    Ptr<ListPositionAllocator> positions = CreateObject<ListPositionAllocator>();
+    const double enbHeight = 20.0;
+
+    uint32_t cols = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(numEnbs))));
+    uint32_t rows = (numEnbs + cols - 1) / cols;
+
+    double dx;
+    double dy;
+    double rowShift = 0.0;
+    if (layout == "hex")
+    {
+        // Leave room for the half-spacing shift of the odd rows
+        dx = cols > 1 ? areaSize / (cols - 0.5) : 0.0;
+        dy = rows > 1 ? std::min(dx * std::sqrt(3.0) / 2.0, areaSize / (rows - 1)) : 0.0;
+        rowShift = dx / 2.0;
+    }
+    else
+    {
+        dx = cols > 1 ? areaSize / (cols - 1) : 0.0;
+        dy = rows > 1 ? areaSize / (rows - 1) : 0.0;
+    }
+
+    for (uint32_t i = 0; i < numEnbs; ++i)
+    {
+        uint32_t row = i / cols;
+        uint32_t col = i % cols;
+        double x = col * dx + ((row % 2) ? rowShift : 0.0);
+        positions->Add(Vector(x, row * dy, enbHeight));
+    }
+    return positions;
+}
+
+/**
+ * Aggregate KPIs of a finished run, per traffic class (identified by destination port):
+ * throughput summed over flows, mean one-way delay and packet loss ratio.
+ */
+static SweepRunner::Kpis
+SummarizeFlows(Ptr<FlowMonitor> monitor,
+               Ptr<Ipv4FlowClassifier> classifier,
+               uint16_t bulkPort,
+               uint16_t webPort)
+{
+    struct ClassTotals
+    {
+        double throughputMbps = 0;
+        double delaySum = 0;
+        uint64_t rxPackets = 0;
+        uint64_t txPackets = 0;
+        uint64_t lostPackets = 0;
+    };
+    std::map<std::string, ClassTotals> classes;
+
+    for (const auto& entry : monitor->GetFlowStats())
+    {
+        Ipv4FlowClassifier::FiveTuple t = classifier->FindFlow(entry.first);
+        std::string name = t.destinationPort == bulkPort  ? "bulk"
+                           : t.destinationPort == webPort ? "web"
+                                                          : "other";
+        const FlowMonitor::FlowStats& fs = entry.second;
+        ClassTotals& c = classes[name];
+        double active = (fs.timeLastRxPacket - fs.timeFirstTxPacket).GetSeconds();
+        if (active > 0)
+        {
+            c.throughputMbps += fs.rxBytes * 8.0 / active / 1e6;
+        }
+        c.delaySum += fs.delaySum.GetSeconds();
+        c.rxPackets += fs.rxPackets;
+        c.txPackets += fs.txPackets;
+        c.lostPackets += fs.lostPackets;
+    }
+
+    SweepRunner::Kpis kpis;
+    for (const auto& c : classes)
+    {
+        kpis[c.first + "_throughput_mbps"] = c.second.throughputMbps;
+        kpis[c.first + "_mean_delay_ms"] =
+            c.second.rxPackets ? 1e3 * c.second.delaySum / c.second.rxPackets : 0.0;
+        kpis[c.first + "_loss_ratio"] =
+            c.second.txPackets ? static_cast<double>(c.second.lostPackets) / c.second.txPackets
+                               : 0.0;
+    }
+    return kpis;
+}
+
+/// Ends the warm-up Run() of --warmup=fast and --snapshotReplications
+static void
+StopSimulation()
+{
+    Simulator::Stop();
+}
+
+/**
+ * Insert \p suffix before the extension of \p fileName ("kpi-lte.csv" -> "kpi-lte-rep1.csv"),
+ * or append it when the file name has none. An empty name (output off) stays empty.
+ */
+static void
+AddFileSuffix(std::string& fileName, const std::string& suffix)
+{
+    size_t dot = fileName.rfind('.');
+    size_t slash = fileName.rfind('/');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+    {
+        dot = fileName.size();
+    }
+    if (!fileName.empty())
+    {
+        fileName.insert(dot, suffix);
+    }
+}
+
+/**
+ * Nodes of \p nodes owned by MPI rank \p systemId. Every rank builds the whole topology,
+ * but applications and FlowMonitor probes must only be installed on the local nodes.
+ */
+static NodeContainer
+LocalNodes(const NodeContainer& nodes, uint32_t systemId)
+{
+    NodeContainer local;
+    for (auto it = nodes.Begin(); it != nodes.End(); ++it)
+    {
+        if ((*it)->GetSystemId() == systemId)
+        {
+            local.Add(*it);
+        }
+    }
+    return local;
+}
+
+/// Devices of \p devices whose node is owned by MPI rank \p systemId
+static NetDeviceContainer
+LocalDevices(const NetDeviceContainer& devices, uint32_t systemId)
+{
+    NetDeviceContainer local;
+    for (auto it = devices.Begin(); it != devices.End(); ++it)
+    {
+        if ((*it)->GetNode()->GetSystemId() == systemId)
+        {
+            local.Add(*it);
+        }
+    }
+    return local;
+}
+
+/// Counts completed handovers (UE side HandoverEndOk)
+static void
+CountHandover(uint64_t* handovers,
+              std::string /* context */,
+              uint64_t /* imsi */,
+              uint16_t /* cellId */,
+              uint16_t /* rnti */)
+{
+    ++*handovers;
+}
+
+/// --vehicleTrace sink for WaypointMobilityModel UEs
+static void
+AddNodeWaypoint(NodeContainer nodes, uint32_t index, const Waypoint& waypoint)
+{
+    nodes.Get(index)->GetObject<WaypointMobilityModel>()->AddWaypoint(waypoint);
+}
+
+/**
+ * Smallest SRS periodicity (ms) that leaves one SRS configuration index per UE
+ * attached to an eNB; the LteEnbRrc default of 40 aborts beyond that many UEs.
+ */
+static uint32_t
+SrsPeriodicityFor(uint32_t uesPerEnb)
+{
+    static const uint32_t periodicities[] = {2, 5, 10, 20, 40, 80, 160, 320};
+    for (uint32_t p : periodicities)
+    {
+        if (uesPerEnb < p)
+        {
+            return p;
+        }
+    }
+    NS_FATAL_ERROR("Too many UEs per eNB (" << uesPerEnb << "), at most 319 are supported");
+    return 0;
+}
+
+/// TypeId name of the --eventQueue backend
+static std::string
+EventQueueTypeFor(const std::string& name)
+{
+    if (name == "map")
+    {
+        return "ns3::MapScheduler";
+    }
+    if (name == "heap")
+    {
+        return "ns3::HeapScheduler";
+    }
+    if (name == "calendar")
+    {
+        return "ns3::CalendarScheduler";
+    }
+    if (name == "list")
+    {
+        return "ns3::ListScheduler";
+    }
+    if (name == "tti")
+    {
+        return "ns3::TtiBucketScheduler";
+    }
+    NS_FATAL_ERROR("Unknown --eventQueue " << name << " (use map, heap, calendar, list or tti)");
+    return "";
+}
+
+/**
+ * The whole scenario: parse \p argv, build, run and report. Separate from main() so
+ * the benchmark suite can run it at other scales in forked children.
+ */
+static int
+RunScenario(int argc, char *argv[])
 {
     double simTime = 20.0; // seconds
+    std::string flowmonScope = "all";
+    uint32_t numEnbs = 4;
+    uint32_t numUes = 10;
+    double areaSize = 200.0; // meters, side of the square covered by sites and UEs
+    std::string siteLayout = "grid";
+    std::string flowStatsFormat = "csv";
+    std::string flowStatsFile;
+    double flowStatsInterval = 1.0; // seconds
+    bool flowmonHistograms = false;
+    bool profile = false;
+    double profileSampleInterval = 1.0; // seconds of simulated time
+    std::string eventQueue = "map";
+    std::string webRate = "5Mbps";
+    double walkSpeed = 5.0; // m/s
+    std::string runSummaryFile;
+    std::string sweep;
+    uint32_t sweepJobs = 0;
+    std::string sweepDir = "sweep-runs";
+    std::string sweepSummary = "sweep-summary.csv";
+    bool benchmarkSuite = false;
+    std::string benchmarkScales = "10:4,100:4,1000:4,5000:20";
+    std::string benchmarkDir = "benchmark-runs";
+    std::string benchmarkFile = "benchmark.json";
+    std::string benchmarkBaseline; // empty = no comparison
+    double benchmarkThreshold = 0.1;
+    bool distributed = false;
+    std::string bulkModel = "tcp";
+    std::string webModel = "onoff";
+    std::string webActivation = "always";
+    std::string routing = "static";
+    double sessionRate = 0.1;     // session arrivals per second of an idle UE
+    double sessionDuration = 5.0; // mean seconds
+    std::string mobilityModel = "ns3";
+    double mobilityStep = 0.1; // seconds
+    std::string pathlossModel = "ns3::FriisPropagationLossModel";
+    double interferenceCutoff = 0.0;     // meters, 0 = off
+    double pathlossCacheThreshold = 0.0; // meters, 0 = off
+    uint32_t dlBandwidth = 25; // resource blocks
+    uint32_t ulBandwidth = 25;
+    uint32_t dlEarfcn = 100;
+    uint32_t ulEarfcn = 18100;
+    uint32_t numCarriers = 1;
+    std::string carrierStatsFile; // empty = off
+    std::string scheduler = "PF";
+    std::string schedulerBench; // empty = off
+    std::string schedulerBenchUes = "10,100,1000";
+    uint32_t schedulerBenchTtis = 10000;
+    std::string selfTest; // empty = off
+    std::string handover = "none";
+    std::string attachMode = "round-robin";
+    double handoverHysteresis = 3.0; // dB
+    uint32_t handoverTtt = 256;      // ms
+    uint32_t measurementPeriod = 200; // ms
+    std::string remCache; // empty = off
+    double remResolution = 5.0; // meters
+    std::string vehicleTrace;
+    std::string vehicleTraceFormat = "fcd";
+    double vehicleLookahead = 10.0; // seconds
+    std::string progress;            // empty = off
+    double progressInterval = 100.0; // milliseconds of simulated time
+    double progressPeriod = 5.0;     // wall-clock seconds
+    double kpiInterval = 0.0; // seconds, 0 = off
+    std::string kpiFile = "kpi-lte.csv";
+    uint32_t kpiRingCapacity = 1 << 16;
+    double kpiWindow = 0.0; // seconds, 0 = off
+    uint32_t kpiWindowSlices = 10;
+    std::string kpiWindowFile = "kpi-windows.csv";
+    double steadyStateTolerance = 0.0; // relative, 0 = run to --simTime
+    uint32_t steadyStateBatches = 5;
+    double steadyStateMinTime = 5.0; // seconds
+    std::string warmup = "fixed";
+    bool packetPool = false;
+    uint32_t packetPoolReserve = 4096; // MiB of address space
+    uint32_t snapshotReplications = 0;
+    uint32_t snapshotJobs = 0;
+    std::string traceLayers; // empty = off
+    std::string traceUes = "all";
+    std::string traceEnbs = "all";
+    double traceWindow = 0.1; // seconds
+    std::string traceFile = "lte-traces.bin";
     CommandLine cmd;
+    cmd.AddValue("simTime", "Simulated time in seconds", simTime);
+    cmd.AddValue("numEnbs", "Number of eNBs", numEnbs);
+    cmd.AddValue("numUes", "Number of UEs", numUes);
+    cmd.AddValue("areaSize", "Side of the square simulation area in meters", areaSize);
+    cmd.AddValue("siteLayout", "eNB site layout: grid or hex", siteLayout);
+    cmd.AddValue("flowmonScope",
+                 "Nodes that get FlowMonitor probes: all, ue-only, remote-host-only, pgw-only. "
+                 "A flow is only seen where its packets were sent from a probed node, so "
+                 "ue-only only has uplink ACK flows, remote-host-only no deliveries (every "
+                 "downlink packet counts as lost) and pgw-only only the GTP-U tunnel flows",
+                 flowmonScope);
+    cmd.AddValue("flowStatsFormat", "Flow statistics output: csv, binary or xml", flowStatsFormat);
+    cmd.AddValue("flowStatsFile",
+                 "Flow statistics file (default flowmon-lte.csv, .bin or .xml)",
+                 flowStatsFile);
+    cmd.AddValue("flowStatsInterval",
+                 "Seconds of simulated time between two csv/binary exports",
+                 flowStatsInterval);
+    cmd.AddValue("flowmonHistograms",
+                 "Keep FlowMonitor delay/jitter/size histograms (xml output only)",
+                 flowmonHistograms);
+    cmd.AddValue("profile", "Report wall time, events and RSS per scenario phase", profile);
+    cmd.AddValue("profileSampleInterval",
+                 "Seconds of simulated time between two events/s samples in --profile mode",
+                 profileSampleInterval);
+    cmd.AddValue("eventQueue",
+                 "Simulator event queue: map, heap, calendar, list or tti (1 ms buckets)",
+                 eventQueue);
+    cmd.AddValue("webRate", "Data rate of each OnOff (web-like) flow", webRate);
+    cmd.AddValue("bulkModel",
+                 "Bulk traffic to the random-walk UEs: tcp (BulkSend) or saturated (full buffer)",
+                 bulkModel);
+    cmd.AddValue("webModel",
+                 "Web traffic to the waypoint UEs: onoff (constant rate) or session (pages)",
+                 webModel);
+    cmd.AddValue("webActivation",
+                 "always (web apps on every waypoint UE for the whole run) or ondemand "
+                 "(created per session)",
+                 webActivation);
+    cmd.AddValue("sessionRate",
+                 "With --webActivation=ondemand, session arrivals per second of an idle UE",
+                 sessionRate);
+    cmd.AddValue("sessionDuration",
+                 "With --webActivation=ondemand, mean (exponential) session length in seconds",
+                 sessionDuration);
+    cmd.AddValue("routing",
+                 "IPv4 routing of UEs, remote hosts and PGW: static (list + static routing) "
+                 "or trie (longest-prefix-match trie, routes set at stack install)",
+                 routing);
+    cmd.AddValue("walkSpeed", "Speed of the RandomWalk2d UEs in m/s", walkSpeed);
+    cmd.AddValue("mobilityModel",
+                 "UE mobility: ns3 (one mobility model per UE) or population (batched)",
+                 mobilityModel);
+    cmd.AddValue("mobilityStep",
+                 "Seconds of simulated time between two --mobilityModel=population updates",
+                 mobilityStep);
+    cmd.AddValue("pathlossModel", "TypeId of the LTE path-loss model", pathlossModel);
+    cmd.AddValue("interferenceCutoff",
+                 "Meters beyond which eNB/UE pairs are ignored by the channel (0 = all pairs)",
+                 interferenceCutoff);
+    cmd.AddValue("pathlossCacheThreshold",
+                 "Meters either end must move before a cached pair path loss is recomputed "
+                 "(0 = no cache)",
+                 pathlossCacheThreshold);
+    cmd.AddValue("handover", "Handover algorithm: none, a3-rsrp or a2-a4 (adds X2)", handover);
+    cmd.AddValue("attachMode",
+                 "Initial cell: round-robin (UE i on eNB i % numEnbs) or auto (cell selection)",
+                 attachMode);
+    cmd.AddValue("handoverHysteresis", "A3 hysteresis in dB", handoverHysteresis);
+    cmd.AddValue("handoverTtt",
+                 "A3 time-to-trigger in ms; the condition must hold that long before a report",
+                 handoverTtt);
+    cmd.AddValue("measurementPeriod",
+                 "Milliseconds over which UE PHY measurements are filtered before each report "
+                 "to RRC",
+                 measurementPeriod);
+    cmd.AddValue("remCache",
+                 "Directory of precomputed path-loss map tiles for the eNB sites (empty = off)",
+                 remCache);
+    cmd.AddValue("remResolution", "Grid spacing of the --remCache tiles in meters", remResolution);
+    cmd.AddValue("vehicleTrace",
+                 "SUMO FCD / ns-2 mobility file driving the waypoint UEs (empty = fixed loop)",
+                 vehicleTrace);
+    cmd.AddValue("vehicleTraceFormat", "Format of --vehicleTrace: fcd or ns2", vehicleTraceFormat);
+    cmd.AddValue("vehicleLookahead",
+                 "Seconds of --vehicleTrace converted into waypoints ahead of simulated time",
+                 vehicleLookahead);
+    cmd.AddValue("runSummaryFile", "Write the run's aggregate KPIs to this file", runSummaryFile);
+    cmd.AddValue("dlBandwidth", "Downlink bandwidth of each carrier in RBs", dlBandwidth);
+    cmd.AddValue("ulBandwidth", "Uplink bandwidth of each carrier in RBs", ulBandwidth);
+    cmd.AddValue("dlEarfcn", "Downlink EARFCN of the first carrier", dlEarfcn);
+    cmd.AddValue("ulEarfcn", "Uplink EARFCN of the first carrier", ulEarfcn);
+    cmd.AddValue("numCarriers", "Component carriers per eNB (> 1 enables CA)", numCarriers);
+    cmd.AddValue("carrierStatsFile",
+                 "Per-eNB, per-carrier MAC throughput CSV (empty = off)",
+                 carrierStatsFile);
+    cmd.AddValue("scheduler", "eNB MAC scheduler: PF, RR, TD-MT, PSS or CQA", scheduler);
+    cmd.AddValue("schedulerBench",
+                 "Benchmark these schedulers instead of simulating, e.g. \"PF,PF-array\" or all",
+                 schedulerBench);
+    cmd.AddValue("schedulerBenchUes", "UE counts of --schedulerBench", schedulerBenchUes);
+    cmd.AddValue("schedulerBenchTtis", "TTIs per --schedulerBench run", schedulerBenchTtis);
+    cmd.AddValue("selfTest",
+                 "Run these component checks instead of simulating (comma-separated or all)",
+                 selfTest);
+    cmd.AddValue("sweep",
+                 "Parameter grid to sweep, e.g. \"numUes=10,100;webRate=1Mbps,5Mbps;runs=1-10\"",
+                 sweep);
+    cmd.AddValue("sweepJobs", "Concurrent sweep processes (0 = number of cores)", sweepJobs);
+    cmd.AddValue("sweepDir", "Directory for the per-run files of a sweep", sweepDir);
+    cmd.AddValue("sweepSummary", "Merged sweep table with confidence intervals", sweepSummary);
+    cmd.AddValue("benchmarkSuite",
+                 "Run the scenario at every --benchmarkScales point",
+                 benchmarkSuite);
+    cmd.AddValue("benchmarkScales",
+                 "Benchmark points as ues:enbs, e.g. \"10:4,100:4,1000:4,5000:20\"",
+                 benchmarkScales);
+    cmd.AddValue("benchmarkDir",
+                 "Directory for the per-point files of the benchmark",
+                 benchmarkDir);
+    cmd.AddValue("benchmarkFile", "Benchmark results (JSON)", benchmarkFile);
+    cmd.AddValue("benchmarkBaseline",
+                 "Earlier --benchmarkFile to compare with (empty = no comparison)",
+                 benchmarkBaseline);
+    cmd.AddValue("benchmarkThreshold",
+                 "Relative wall time / peak RSS growth over the baseline that fails the suite",
+                 benchmarkThreshold);
+    cmd.AddValue("progress",
+                 "Live progress during the run: stderr, unix:<path> or "
+                 "prometheus:[<address>:]<port> (empty = off)",
+                 progress);
+    cmd.AddValue("progressInterval",
+                 "Milliseconds of simulated time between two progress readings",
+                 progressInterval);
+    cmd.AddValue("progressPeriod",
+                 "Wall-clock seconds between two progress publications",
+                 progressPeriod);
+    cmd.AddValue("kpiInterval",
+                 "Seconds of simulated time between two KPI samples (0 = no sampling)",
+                 kpiInterval);
+    cmd.AddValue("kpiFile", "KPI sample output file", kpiFile);
+    cmd.AddValue("kpiRingCapacity",
+                 "KPI records buffered for the writer thread before samples are dropped",
+                 kpiRingCapacity);
+    cmd.AddValue("kpiWindow",
+                 "Seconds of simulated time covered by the sliding KPI windows (0 = off)",
+                 kpiWindow);
+    cmd.AddValue("kpiWindowSlices",
+                 "Sub-windows per KPI window; one row per class and eNB is written per slice",
+                 kpiWindowSlices);
+    cmd.AddValue("kpiWindowFile", "Sliding-window KPI output file", kpiWindowFile);
+    cmd.AddValue("steadyStateTolerance",
+                 "Stop once the 95% interval of every windowed KPI is within this fraction of "
+                 "its mean (0 = always run --simTime; enables --kpiWindow=1 if unset)",
+                 steadyStateTolerance);
+    cmd.AddValue("steadyStateBatches", "Batch means used by the steady-state test", steadyStateBatches);
+    cmd.AddValue("steadyStateMinTime",
+                 "Seconds of simulated time before the steady-state test may stop the run",
+                 steadyStateMinTime);
+    cmd.AddValue("traceLayers",
+                 "LTE layers to trace, comma-separated subset of phy,mac,rlc,pdcp (empty = off)",
+                 traceLayers);
+    cmd.AddValue("traceUes", "UE indices to trace, e.g. \"0-9,12\" or all", traceUes);
+    cmd.AddValue("traceEnbs", "eNB indices to trace, e.g. \"0,2\" or all", traceEnbs);
+    cmd.AddValue("traceWindow", "Seconds of simulated time aggregated per trace record", traceWindow);
+    cmd.AddValue("traceFile", "Binary LTE trace output file", traceFile);
+    cmd.AddValue("packetPool",
+                 "Serve small allocations (packets, buffers, events) from pooled free lists",
+                 packetPool);
+    cmd.AddValue("packetPoolReserve",
+                 "Address space reserved by --packetPool in MiB (committed as used)",
+                 packetPoolReserve);
+    cmd.AddValue("warmup",
+                 "Application start: fixed (0.5-2 s) or fast (as soon as every UE is attached)",
+                 warmup);
+    cmd.AddValue("snapshotReplications",
+                 "Fork this many replications from the post-attach state (0 = off)",
+                 snapshotReplications);
+    cmd.AddValue("snapshotJobs",
+                 "Concurrent snapshot replications (0 = number of cores)",
+                 snapshotJobs);
+    cmd.AddValue("distributed",
+                 "Run the remote hosts and the EPC/radio side in two MPI ranks",
+                 distributed);
     cmd.Parse(argc, argv);
 
+    if (flowmonScope != "all" && flowmonScope != "ue-only" &&
+        flowmonScope != "remote-host-only" && flowmonScope != "pgw-only")
+    {
+        NS_FATAL_ERROR("Unknown --flowmonScope=" << flowmonScope
+                       << " (expected all, ue-only, remote-host-only or pgw-only)");
+    }
+    // Ipv4FlowProbe classifies a packet when a probed node sends it and only accounts
+    // forwards / deliveries of packets classified that way
+    if (flowmonScope == "ue-only")
+    {
+        std::cerr << "warning: --flowmonScope=ue-only records only the UEs' uplink flows "
+                     "(TCP ACKs) as sent, no downlink flow and no delivery" << std::endl;
+    }
+    else if (flowmonScope == "remote-host-only")
+    {
+        std::cerr << "warning: --flowmonScope=remote-host-only records the downlink flows as "
+                     "sent, never as received: every packet counts as lost" << std::endl;
+    }
+    else if (flowmonScope == "pgw-only")
+    {
+        std::cerr << "warning: --flowmonScope=pgw-only records only the PGW's GTP-U tunnel "
+                     "flows to the eNBs, as sent, not the user flows" << std::endl;
+    }
+    if (flowStatsFormat != "xml")
+    {
+        FlowStatsExporter::ParseFormat(flowStatsFormat); // aborts on unknown names
+    }
+    if (flowStatsFile.empty())
+    {
+        flowStatsFile = flowStatsFormat == "binary" ? "flowmon-lte.bin"
+                        : flowStatsFormat == "xml"  ? "flowmon-lte.xml"
+                                                    : "flowmon-lte.csv";
+    }
+    if (bulkModel != "tcp" && bulkModel != "saturated")
+    {
+        NS_FATAL_ERROR("Unknown --bulkModel=" << bulkModel << " (expected tcp or saturated)");
+    }
+    if (webModel != "onoff" && webModel != "session")
+    {
+        NS_FATAL_ERROR("Unknown --webModel=" << webModel << " (expected onoff or session)");
+    }
+    if (webActivation != "always" && webActivation != "ondemand")
+    {
+        NS_FATAL_ERROR("Unknown --webActivation=" << webActivation
+                                                  << " (expected always or ondemand)");
+    }
+    if (routing != "static" && routing != "trie")
+    {
+        NS_FATAL_ERROR("Unknown --routing=" << routing << " (expected static or trie)");
+    }
+    NS_ABORT_MSG_IF(sessionRate < 0 || sessionDuration <= 0,
+                    "--sessionRate must be >= 0 and --sessionDuration positive");
+    if (siteLayout != "grid" && siteLayout != "hex")
+    {
+        NS_FATAL_ERROR("Unknown --siteLayout=" << siteLayout << " (expected grid or hex)");
+    }
+    NS_ABORT_MSG_IF(numEnbs == 0 || numUes == 0, "--numEnbs and --numUes must be positive");
+    if (mobilityModel != "ns3" && mobilityModel != "population")
+    {
+        NS_FATAL_ERROR("Unknown --mobilityModel=" << mobilityModel
+                                                  << " (expected ns3 or population)");
+    }
+    if (handover != "none" && handover != "a3-rsrp" && handover != "a2-a4")
+    {
+        NS_FATAL_ERROR("Unknown --handover=" << handover << " (expected none, a3-rsrp or a2-a4)");
+    }
+    if (attachMode != "round-robin" && attachMode != "auto")
+    {
+        NS_FATAL_ERROR("Unknown --attachMode=" << attachMode
+                                               << " (expected round-robin or auto)");
+    }
+    if (warmup != "fixed" && warmup != "fast")
+    {
+        NS_FATAL_ERROR("Unknown --warmup=" << warmup << " (expected fixed or fast)");
+    }
+    if (steadyStateTolerance > 0 && kpiWindow == 0)
+    {
+        kpiWindow = 1.0;
+    }
+    NS_ABORT_MSG_IF(distributed && kpiWindow > 0,
+                    "--kpiWindow matches sends and deliveries in one process, drop --distributed");
+    NS_ABORT_MSG_IF(distributed && snapshotReplications > 0,
+                    "--snapshotReplications cannot fork MPI ranks, drop --distributed");
+    NS_ABORT_MSG_IF(distributed && webActivation == "ondemand",
+                    "--webActivation=ondemand needs the UEs and the web server on one rank");
+    NS_ABORT_MSG_IF(distributed && warmup == "fast",
+                    "--warmup=fast needs every UE's attach in one process, drop --distributed");
+
+    for (uint32_t bandwidth : {dlBandwidth, ulBandwidth})
+    {
+        if (bandwidth != 6 && bandwidth != 15 && bandwidth != 25 && bandwidth != 50 &&
+            bandwidth != 75 && bandwidth != 100)
+        {
+            NS_FATAL_ERROR("Unsupported bandwidth " << bandwidth
+                                                    << " RBs (expected 6, 15, 25, 50, 75 or 100)");
+        }
+    }
+    NS_ABORT_MSG_IF(numCarriers == 0 || numCarriers > MAX_NO_CC,
+                    "--numCarriers must be within 1.." << MAX_NO_CC);
+
+    if (packetPool)
+    {
+        PooledAllocator::Enable(static_cast<size_t>(packetPoolReserve) << 20);
+        NS_ABORT_MSG_UNLESS(PooledAllocator::IsEnabled(),
+                            "Cannot reserve " << packetPoolReserve << " MiB for --packetPool");
+    }
+
+    std::string schedulerType = MacSchedulerBench::GetSchedulerTypeName(scheduler);
+    std::string eventQueueType = EventQueueTypeFor(eventQueue);
+    if (!selfTest.empty())
+    {
+        return SelfTest::Run(selfTest, std::cout);
+    }
+    if (!schedulerBench.empty())
+    {
+        return MacSchedulerBench::Run(schedulerBench,
+                                      schedulerBenchUes,
+                                      schedulerBenchTtis,
+                                      dlBandwidth,
+                                      std::cout);
+    }
+    if (benchmarkSuite)
+    {
+        std::string extension = flowStatsFormat == "binary" ? "bin" : flowStatsFormat;
+        BenchmarkSuite suite(benchmarkScales, benchmarkDir, extension);
+        return suite.Run(&RunScenario,
+                         argc,
+                         argv,
+                         benchmarkFile,
+                         benchmarkBaseline,
+                         benchmarkThreshold);
+    }
+    if (!sweep.empty())
+    {
+        // One publisher per run: concurrent children would fight over the socket or port
+        NS_ABORT_MSG_IF(!progress.empty(), "--progress cannot be combined with --sweep");
+        std::string extension = flowStatsFormat == "binary" ? "bin" : flowStatsFormat;
+        SweepRunner runner(sweep,
+                           sweepJobs,
+                           sweepDir,
+                           extension,
+                           {{"kpiFile", kpiFile},
+                            {"kpiWindowFile", kpiWindowFile},
+                            {"traceFile", traceFile},
+                            {"carrierStatsFile", carrierStatsFile}});
+        return runner.Run(argc, argv, sweepSummary);
+    }
+
+    // ----------------------------
+    // Distributed execution: rank 0 owns the EPC core, eNBs and UEs, rank 1 the remote
+    // hosts. The radio side stays on one rank: all eNBs share one spectrum channel and
+    // reach the MME through direct S1-AP SAP calls, neither of which can cross ranks.
+    // ----------------------------
+    uint32_t systemId = 0;
+    uint32_t systemCount = 1;
+    const uint32_t radioRank = 0;
+    uint32_t remoteHostRank = 0;
+    if (distributed)
+    {
+#ifdef NS3_MPI
+        GlobalValue::Bind("SimulatorImplementationType",
+                          StringValue("ns3::DistributedSimulatorImpl"));
+        MpiInterface::Enable(&argc, &argv);
+        systemId = MpiInterface::GetSystemId();
+        systemCount = MpiInterface::GetSize();
+        NS_ABORT_MSG_UNLESS(systemCount == 2,
+                            "--distributed needs exactly 2 MPI ranks (got " << systemCount
+                                                                            << ")");
+        remoteHostRank = 1;
+#else
+        NS_FATAL_ERROR("--distributed requires ns-3 configured with --enable-mpi");
+#endif
+    }
+    if (systemCount > 1)
+    {
+        // Per-rank output files
+        std::string suffix = "-rank" + std::to_string(systemId);
+        for (std::string* fileName : {&flowStatsFile, &runSummaryFile, &carrierStatsFile})
+        {
+            AddFileSuffix(*fileName, suffix);
+        }
+    }
+
+    // Round-robin attach puts at most ceil(numUes / numEnbs) UEs on one cell; with cell
+    // selection or handover any cell may end up with all of them
+    uint32_t maxUesPerEnb = (numUes + numEnbs - 1) / numEnbs;
+    if (attachMode == "auto" || handover != "none")
+    {
+        maxUesPerEnb = std::min(numUes, 319u);
+    }
+    Config::SetDefault("ns3::LteEnbRrc::SrsPeriodicity",
+                       UintegerValue(SrsPeriodicityFor(maxUesPerEnb)));
+    // One layer-3 measurement report per UE and period, whatever the number of cells
+    Config::SetDefault("ns3::LteUePhy::UeMeasurementsFilterPeriod",
+                       TimeValue(MilliSeconds(measurementPeriod)));
+
+    if (numCarriers > 1)
+    {
+        // LteHelper builds its component carrier layout from these when it is created
+        Config::SetDefault("ns3::LteHelper::UseCa", BooleanValue(true));
+        Config::SetDefault("ns3::LteHelper::NumberOfComponentCarriers", UintegerValue(numCarriers));
+        Config::SetDefault("ns3::LteHelper::EnbComponentCarrierManager",
+                           StringValue("ns3::RrComponentCarrierManager"));
+    }
+
+    // Event queue backend; under --profile wrapped so the profile reports its load
+    ObjectFactory eventQueueFactory;
+    if (profile)
+    {
+        eventQueueFactory.SetTypeId(InstrumentedScheduler::GetTypeId());
+        eventQueueFactory.Set("SchedulerType", TypeIdValue(TypeId::LookupByName(eventQueueType)));
+    }
+    else
+    {
+        eventQueueFactory.SetTypeId(eventQueueType);
+    }
+    Simulator::SetScheduler(eventQueueFactory);
+
+    ScenarioProfiler profiler(profile);
+    profiler.SetEventQueue(eventQueue);
+    profiler.StartPhase("epc+remote-hosts");
+
     // Create LTE + EPC helpers
     Ptr<LteHelper> lteHelper = CreateObject<LteHelper>();
     Ptr<PointToPointEpcHelper> epcHelper = CreateObject<PointToPointEpcHelper>();
     lteHelper->SetEpcHelper(epcHelper);
+    lteHelper->SetSchedulerType(schedulerType);
+    lteHelper->SetEnbDeviceAttribute("DlBandwidth", UintegerValue(dlBandwidth));
+    lteHelper->SetEnbDeviceAttribute("UlBandwidth", UintegerValue(ulBandwidth));
+    lteHelper->SetEnbDeviceAttribute("DlEarfcn", UintegerValue(dlEarfcn));
+    lteHelper->SetEnbDeviceAttribute("UlEarfcn", UintegerValue(ulEarfcn));
+    lteHelper->SetUeDeviceAttribute("DlEarfcn", UintegerValue(dlEarfcn));
+    if (handover == "a3-rsrp")
+    {
+        lteHelper->SetHandoverAlgorithmType("ns3::A3RsrpHandoverAlgorithm");
+        lteHelper->SetHandoverAlgorithmAttribute("Hysteresis", DoubleValue(handoverHysteresis));
+        lteHelper->SetHandoverAlgorithmAttribute("TimeToTrigger",
+                                                 TimeValue(MilliSeconds(handoverTtt)));
+    }
+    else if (handover == "a2-a4")
+    {
+        lteHelper->SetHandoverAlgorithmType("ns3::A2A4RsrqHandoverAlgorithm");
+        lteHelper->SetHandoverAlgorithmAttribute("ServingCellThreshold", UintegerValue(30));
+        lteHelper->SetHandoverAlgorithmAttribute("NeighbourCellOffset", UintegerValue(1));
+    }
+    if (!remCache.empty())
+    {
+        // The map stands in for the configured model (and can itself be wrapped below)
+        Config::SetDefault("ns3::RemCacheLossModel::Model", StringValue(pathlossModel));
+        Config::SetDefault("ns3::RemCacheLossModel::CacheDir", StringValue(remCache));
+        Config::SetDefault("ns3::RemCacheLossModel::Bounds",
+                           RectangleValue(Rectangle(0, areaSize, 0, areaSize)));
+        Config::SetDefault("ns3::RemCacheLossModel::Resolution", DoubleValue(remResolution));
+        pathlossModel = "ns3::RemCacheLossModel";
+    }
+    if (interferenceCutoff > 0 || pathlossCacheThreshold > 0)
+    {
+        lteHelper->SetAttribute("PathlossModel", StringValue("ns3::SpatialCutoffLossModel"));
+        lteHelper->SetPathlossModelAttribute("Model", StringValue(pathlossModel));
+        lteHelper->SetPathlossModelAttribute("CutoffDistance", DoubleValue(interferenceCutoff));
+        lteHelper->SetPathlossModelAttribute("MovementThreshold",
+                                             DoubleValue(pathlossCacheThreshold));
+        // Lets the channel drop the cut-off pairs before scheduling their reception
+        lteHelper->SetSpectrumChannelAttribute("MaxLossDb",
+                                               DoubleValue(SpatialCutoffLossModel::GetMaxLossDb()));
+    }
+    else
+    {
+        lteHelper->SetAttribute("PathlossModel", StringValue(pathlossModel));
+    }
 
     // PGW node (EPC)
     Ptr<Node> pgw = epcHelper->GetPgwNode();
@@ -55,7 +911,11 @@ main(int argc, char *argv[])
     // Remote hosts (2): one for BulkSend, one for OnOff (web-like)
     // ----------------------------
     NodeContainer remoteHosts;
-    remoteHosts.Create(2);
+    remoteHosts.Create(2, remoteHostRank);
+    if (routing == "trie")
+    {
+        internet.SetRoutingHelper(TrieIpv4RoutingHelper());
+    }
     internet.Install(remoteHosts);
 
     // Connect remote hosts to PGW via point-to-point links using distinct subnets
@@ -82,66 +942,187 @@ main(int argc, char *argv[])
     // ----------------------------
     // eNBs and UEs
     // ----------------------------
+    profiler.StartPhase("nodes+mobility");
     NodeContainer enbs;
-    enbs.Create(4);
+    enbs.Create(numEnbs, radioRank);
 
     NodeContainer ues;
-    ues.Create(10);
+    ues.Create(numUes, radioRank);
 
-    // Install internet stack on UEs (they will get IPs from EPC)
+    // Install internet stack on UEs (they will get IPs from EPC); with --routing=trie
+    // each UE gets its default route to the EPC gateway here, with the stack
+    if (routing == "trie")
+    {
+        TrieIpv4RoutingHelper ueRouting;
+        ueRouting.SetDefaultRoute(epcHelper->GetUeDefaultGatewayAddress(), 1);
+        internet.SetRoutingHelper(ueRouting);
+    }
     internet.Install(ues);
 
-    // Mobility for eNBs (static positions)
-    MobilityHelper enbMobility;
-    Ptr<ListPositionAllocator> enbPos = CreateObject<ListPositionAllocator>();
-    enbPos->Add(Vector(0.0, 0.0, 20.0));
-    enbPos->Add(Vector(200.0, 0.0, 20.0));
-    enbPos->Add(Vector(0.0, 200.0, 20.0));
-    enbPos->Add(Vector(200.0, 200.0, 20.0));
-    enbMobility.SetPositionAllocator(enbPos);
-    enbMobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
-    enbMobility.Install(enbs);
-
-    // Mobility for UEs:
-    // First 5: RandomWalk2dMobilityModel within 0..200 rectangle
-    MobilityHelper ueMobility;
-    for (int i = 0; i < 5; ++i)
-    {
-        MobilityHelper uh;
-        uh.SetPositionAllocator("ns3::RandomRectanglePositionAllocator",
-                                "X", StringValue("ns3::UniformRandomVariable[Min=0|Max=200]"),
-                                "Y", StringValue("ns3::UniformRandomVariable[Min=0|Max=200]"));
-        uh.SetMobilityModel("ns3::RandomWalk2dMobilityModel",
-                            "Speed", StringValue("ns3::ConstantRandomVariable[Constant=5]"),
-                            "Bounds", RectangleValue(Rectangle(0, 200, 0, 200)));
-        uh.Install(ues.Get(i));
-    }
-    // Next 5: Waypoint mobility (car-like waypoints)
-    for (int i = 5; i < 10; ++i)
-    {
-        MobilityHelper wh;
-        wh.SetMobilityModel("ns3::WaypointMobilityModel");
-        wh.Install(ues.Get(i));
-        Ptr<WaypointMobilityModel> wp = ues.Get(i)->GetObject<WaypointMobilityModel>();
-        wp->AddWaypoint(Waypoint(Seconds(0.0), Vector(10, 10, 0)));
-        wp->AddWaypoint(Waypoint(Seconds(5.0), Vector(150, 10, 0)));
-        wp->AddWaypoint(Waypoint(Seconds(10.0), Vector(150, 150, 0)));
-        wp->AddWaypoint(Waypoint(Seconds(15.0), Vector(10, 150, 0)));
+    // First half of the UEs walk randomly and receive BulkSend, the rest follow
+    // waypoints and receive OnOff traffic
+    uint32_t numWalkUes = numUes / 2;
+    NodeContainer walkUes;
+    NodeContainer waypointUes;
+    for (uint32_t i = 0; i < numUes; ++i)
+    {
+        if (i < numWalkUes)
+        {
+            walkUes.Add(ues.Get(i));
+        }
+        else
+        {
+            waypointUes.Add(ues.Get(i));
+        }
+    }
+
+    // Mobility only where the radio side runs: a ghost copy would only add events
+    Ptr<PopulationMobilityManager> populationMobility;
+    std::unique_ptr<TrajectoryStreamer> vehicleStreamer;
+    if (systemId == radioRank)
+    {
+        // Mobility for eNBs (static positions)
+        MobilityHelper enbMobility;
+        enbMobility.SetPositionAllocator(CreateSitePositions(numEnbs, areaSize, siteLayout));
+        enbMobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+        enbMobility.Install(enbs);
+
+        // Mobility for UEs:
+        // First half: random walk within the area, second half: waypoints (car-like), either
+        // streamed from --vehicleTrace or the original 10..150 m loop scaled to the area
+        const bool streamWaypoints = !vehicleTrace.empty();
+        double wpLow = areaSize * 0.05;
+        double wpHigh = areaSize * 0.75;
+        std::vector<Waypoint> loop;
+        if (!streamWaypoints)
+        {
+            loop = {Waypoint(Seconds(0.0), Vector(wpLow, wpLow, 0)),
+                    Waypoint(Seconds(5.0), Vector(wpHigh, wpLow, 0)),
+                    Waypoint(Seconds(10.0), Vector(wpHigh, wpHigh, 0)),
+                    Waypoint(Seconds(15.0), Vector(wpLow, wpHigh, 0))};
+        }
+        MobilityHelper ueMobility;
+        if (mobilityModel == "population")
+        {
+            populationMobility = CreateObjectWithAttributes<PopulationMobilityManager>(
+                "Step", TimeValue(Seconds(mobilityStep)),
+                "Bounds", RectangleValue(Rectangle(0, areaSize, 0, areaSize)),
+                "Speed", DoubleValue(walkSpeed));
+            populationMobility->InstallRandomWalk(walkUes);
+            for (uint32_t i = 0; i < waypointUes.GetN(); ++i)
+            {
+                uint32_t index = populationMobility->InstallWaypoint(waypointUes.Get(i));
+                for (const Waypoint& waypoint : loop)
+                {
+                    populationMobility->AddWaypoint(index, waypoint);
+                }
+            }
+            populationMobility->Start();
+        }
+        else
+        {
+            // RandomWalk2dMobilityModel, one helper for all of them
+            std::ostringstream areaRv;
+            areaRv << "ns3::UniformRandomVariable[Min=0|Max=" << areaSize << "]";
+            std::ostringstream speedRv;
+            speedRv << "ns3::ConstantRandomVariable[Constant=" << walkSpeed << "]";
+            ueMobility.SetPositionAllocator("ns3::RandomRectanglePositionAllocator",
+                                            "X", StringValue(areaRv.str()),
+                                            "Y", StringValue(areaRv.str()));
+            Rectangle bounds(0, areaSize, 0, areaSize);
+            ueMobility.SetMobilityModel("ns3::RandomWalk2dMobilityModel",
+                                        "Speed", StringValue(speedRv.str()),
+                                        "Bounds", RectangleValue(bounds));
+            ueMobility.Install(walkUes);
+
+            MobilityHelper waypointMobility;
+            waypointMobility.SetMobilityModel("ns3::WaypointMobilityModel");
+            waypointMobility.Install(waypointUes);
+            for (uint32_t i = 0; i < waypointUes.GetN(); ++i)
+            {
+                Ptr<WaypointMobilityModel> wp =
+                    waypointUes.Get(i)->GetObject<WaypointMobilityModel>();
+                for (const Waypoint& waypoint : loop)
+                {
+                    wp->AddWaypoint(waypoint);
+                }
+            }
+        }
+
+        if (streamWaypoints)
+        {
+            TrajectoryStreamer::WaypointSink sink;
+            if (populationMobility)
+            {
+                sink = MakeCallback(&PopulationMobilityManager::AddWaypoint, populationMobility);
+            }
+            else
+            {
+                sink = MakeBoundCallback(&AddNodeWaypoint, waypointUes);
+            }
+            vehicleStreamer = std::make_unique<TrajectoryStreamer>(
+                vehicleTrace,
+                TrajectoryStreamer::ParseFormat(vehicleTraceFormat),
+                waypointUes.GetN(),
+                sink,
+                Seconds(vehicleLookahead));
+            vehicleStreamer->Start();
+        }
     }
 
     // ----------------------------
     // Install LTE devices and assign UE IP addresses via EPC helper (ns-3.39)
     // ----------------------------
-    NetDeviceContainer enbDevs = lteHelper->InstallEnbDevice(enbs);
-    NetDeviceContainer ueDevs  = lteHelper->InstallUeDevice(ues);
+    // DistributedSimulatorImpl runs every event scheduled on a rank, whichever rank owns
+    // the node, so LTE devices on the ghost eNB / UE nodes of the remote-host rank would
+    // replay the whole radio side there. That rank only gets what the cross-rank traffic
+    // needs: the UE addresses, from the same EPC allocator in the same order, on
+    // placeholder devices. Node ids and the PGW's device indices match on every rank,
+    // since the LTE install adds no nodes and no PGW devices.
+    profiler.StartPhase("lte-device-install");
+    NetDeviceContainer enbDevs;
+    NetDeviceContainer ueDevs;
+    NetDeviceContainer ueAddressDevs;
+    if (systemId == radioRank)
+    {
+        enbDevs = lteHelper->InstallEnbDevice(enbs);
+        ueDevs = lteHelper->InstallUeDevice(ues);
+        ueAddressDevs = ueDevs;
+    }
+    else
+    {
+        for (uint32_t i = 0; i < ues.GetN(); ++i)
+        {
+            Ptr<SimpleNetDevice> placeholder = CreateObject<SimpleNetDevice>();
+            ues.Get(i)->AddDevice(placeholder);
+            ueAddressDevs.Add(placeholder);
+        }
+    }
 
     // In ns-3.39 use AssignUeIpv4Address (singular) with a NetDeviceContainer
-    Ipv4InterfaceContainer ueIfaces = epcHelper->AssignUeIpv4Address(ueDevs);
+    profiler.StartPhase("ue-ip-assign");
+    Ipv4InterfaceContainer ueIfaces = epcHelper->AssignUeIpv4Address(ueAddressDevs);
+
+    uint64_t handovers = 0;
+    if (handover != "none" && systemId == radioRank)
+    {
+        lteHelper->AddX2Interface(enbs);
+        Config::Connect("/NodeList/*/DeviceList/*/LteUeRrc/HandoverEndOk",
+                        MakeBoundCallback(&CountHandover, &handovers));
+    }
 
-    // Attach UEs to eNBs (round-robin)
-    for (uint32_t i = 0; i < ues.GetN(); ++i)
+    // Attach UEs to eNBs: round-robin, or initial cell selection by each UE
+    profiler.StartPhase("attach");
+    if (attachMode == "auto")
+    {
+        lteHelper->Attach(ueDevs);
+    }
+    else
     {
-        lteHelper->Attach(ueDevs.Get(i), enbDevs.Get(i % enbs.GetN()));
+        for (uint32_t i = 0; i < ueDevs.GetN(); ++i)
+        {
+            lteHelper->Attach(ueDevs.Get(i), enbDevs.Get(i % enbs.GetN()));
+        }
     }
 
     // ----------------------------
@@ -149,11 +1130,12 @@ main(int argc, char *argv[])
     //  - set default route on each UE to EPC/PGW gateway
     //  - add static routes on remote hosts to reach UE network via PGW link address
     // ----------------------------
+    profiler.StartPhase("routing");
     Ipv4StaticRoutingHelper staticRoutingHelper;
 
-    // UE default route -> EPC gateway
+    // UE default route -> EPC gateway (already there with --routing=trie)
     Ipv4Address ueGateway = epcHelper->GetUeDefaultGatewayAddress();
-    for (uint32_t i = 0; i < ues.GetN(); ++i)
+    for (uint32_t i = 0; i < ues.GetN() && routing == "static"; ++i)
     {
         Ptr<Node> ueNode = ues.Get(i);
         Ptr<Ipv4> ipv4 = ueNode->GetObject<Ipv4>();
@@ -168,6 +1150,12 @@ main(int argc, char *argv[])
     for (uint32_t i = 0; i < remoteHosts.GetN(); ++i)
     {
         Ptr<Ipv4> ipv4 = remoteHosts.Get(i)->GetObject<Ipv4>();
+        if (routing == "trie")
+        {
+            DynamicCast<TrieIpv4Routing>(ipv4->GetRoutingProtocol())
+                ->AddNetworkRouteTo(ueNetwork, ueMask, pgwAddressesForRemote[i], 1);
+            continue;
+        }
         Ptr<Ipv4StaticRouting> rhStatic = staticRoutingHelper.GetStaticRouting(ipv4);
 
         rhStatic->AddNetworkRouteTo(
@@ -178,76 +1166,461 @@ main(int argc, char *argv[])
         );
     }
 
+    // PGW: the EPC helper's static routes (UE network via the tunnel device) move to a trie
+    if (routing == "trie")
+    {
+        TrieIpv4Routing::Replace(pgw);
+    }
+
+
+    Simulator::Stop(Seconds(simTime));
+
+    // ----------------------------
+    // Fast warm-up: until the first application starts the LTE stack only runs control
+    // traffic, yet every TTI still costs its full PHY/MAC events. Run just the attach
+    // (RRC connection, S1 context setup, default bearers) and install the applications
+    // afterwards; Application start / stop times are relative to the moment the
+    // application is added to its node, so the schedule below then starts from here.
+    // ----------------------------
+    std::unique_ptr<AttachMonitor> attachMonitor;
+    double appTimeShift = 0.0; // seconds subtracted from the application start times
+    if (warmup == "fast")
+    {
+        profiler.StartPhase("warm-up");
+        attachMonitor = std::make_unique<AttachMonitor>(ueDevs, MakeCallback(&StopSimulation));
+        Simulator::Run();
+        NS_ABORT_MSG_UNLESS(attachMonitor->IsComplete(), "Not every UE attached within --simTime");
+        std::cout << "all UEs attached at " << Simulator::Now().As(Time::S) << std::endl;
+        appTimeShift = 0.5; // the first sinks start right away
+    }
+    // Absolute stop time, whenever the applications are installed
+    Time appStopTime = Seconds(simTime) - Simulator::Now();
+    double bulkStartTime = Simulator::Now().GetSeconds() + 1.0 - appTimeShift;
 
     // ----------------------------
     // Applications: BulkSend (TCP) and OnOff (UDP)
-    // - BulkSend from remoteHosts[0] to UEs 0..4
-    // - OnOff (web-like) from remoteHosts[1] to UEs 5..9
+    // - BulkSend from remoteHosts[0] to the random-walk UEs
+    // - OnOff (web-like) from remoteHosts[1] to the waypoint UEs
+    // Each helper is built once; only the per-UE Remote address changes inside the loops.
     // ----------------------------
+    profiler.StartPhase("applications");
     uint16_t bulkPort = 9000;
     uint16_t webPort  = 8000;
 
     // Install sinks on UEs first, then senders on remote hosts
 
-    // BulkSend sinks on UEs 0..4
-    for (int i = 0; i < 5; ++i)
+    ApplicationContainer bulkSinks;
+    ApplicationContainer bulkApps;
+    if (bulkModel == "saturated")
+    {
+        // Full-buffer sources feed the serving eNB directly, so they live on the EPC side
+        // (PGW node) rather than on the remote host; UEs receive plain UDP
+        PacketSinkHelper bulkSinkHelper("ns3::UdpSocketFactory",
+                                        InetSocketAddress(Ipv4Address::GetAny(), bulkPort));
+        bulkSinks = bulkSinkHelper.Install(LocalNodes(walkUes, systemId));
+        bulkSinks.Start(Seconds(0.5 - appTimeShift));
+
+        Ipv4Address sourceAddress =
+            remoteHosts.Get(0)->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal();
+        for (uint32_t i = 0; i < numWalkUes && radioRank == systemId; ++i)
+        {
+            Ptr<SaturatedSource> source = CreateObject<SaturatedSource>();
+            source->SetAttribute("Port", UintegerValue(bulkPort));
+            source->SetAttribute("SourceAddress", Ipv4AddressValue(sourceAddress));
+            source->Setup(ueDevs.Get(i)->GetObject<LteUeNetDevice>(),
+                          ueIfaces.GetAddress(i),
+                          enbDevs);
+            pgw->AddApplication(source);
+            bulkApps.Add(source);
+        }
+    }
+    else
     {
-        PacketSinkHelper sinkHelper("ns3::TcpSocketFactory",
-                                    InetSocketAddress(Ipv4Address::GetAny(), bulkPort));
-        ApplicationContainer sinks = sinkHelper.Install(ues.Get(i));
-        sinks.Start(Seconds(0.5));
+        // BulkSend sinks on the random-walk UEs
+        PacketSinkHelper bulkSinkHelper("ns3::TcpSocketFactory",
+                                        InetSocketAddress(Ipv4Address::GetAny(), bulkPort));
+        bulkSinks = bulkSinkHelper.Install(LocalNodes(walkUes, systemId));
+        bulkSinks.Start(Seconds(0.5 - appTimeShift));
 
-        // BulkSend from remoteHosts[0] to this UE
-        BulkSendHelper bulk("ns3::TcpSocketFactory",
-                            InetSocketAddress(ueIfaces.GetAddress(i), bulkPort));
+        // BulkSend from remoteHosts[0] to each of these UEs
+        BulkSendHelper bulk("ns3::TcpSocketFactory", Address());
         bulk.SetAttribute("MaxBytes", UintegerValue(0)); // unlimited
-        ApplicationContainer apps = bulk.Install(remoteHosts.Get(0));
-        apps.Start(Seconds(1.0));
-        apps.Stop(Seconds(simTime));
+        for (uint32_t i = 0; i < numWalkUes && remoteHostRank == systemId; ++i)
+        {
+            bulk.SetAttribute("Remote",
+                              AddressValue(InetSocketAddress(ueIfaces.GetAddress(i), bulkPort)));
+            bulkApps.Add(bulk.Install(remoteHosts.Get(0)));
+        }
     }
+    bulkApps.Start(Seconds(1.0 - appTimeShift));
+    bulkApps.Stop(appStopTime);
 
-    // OnOff (UDP) sinks on UEs 5..9 and OnOff apps on remoteHosts[1]
-    for (int i = 5; i < 10; ++i)
+    ApplicationContainer webSinks;
+    ApplicationContainer webApps;
+    Ptr<SessionTrafficManager> sessionManager;
+    if (webActivation == "ondemand")
     {
-        PacketSinkHelper sinkHelper("ns3::UdpSocketFactory",
-                                    InetSocketAddress(Ipv4Address::GetAny(), webPort));
-        ApplicationContainer sinks = sinkHelper.Install(ues.Get(i));
-        sinks.Start(Seconds(1.5));
+        // Sink and sender exist only while a session runs; same sender configuration
+        ObjectFactory senderFactory;
+        if (webModel == "session")
+        {
+            senderFactory.SetTypeId("ns3::WebSessionApplication");
+            senderFactory.Set("DataRate", DataRateValue(DataRate(webRate)));
+            senderFactory.Set("PacketSize", UintegerValue(1024));
+        }
+        else
+        {
+            senderFactory.SetTypeId("ns3::OnOffApplication");
+            senderFactory.Set("Protocol", StringValue("ns3::UdpSocketFactory"));
+            senderFactory.Set("OnTime", StringValue("ns3::ConstantRandomVariable[Constant=1]"));
+            senderFactory.Set("OffTime", StringValue("ns3::ConstantRandomVariable[Constant=0]"));
+            senderFactory.Set("DataRate", DataRateValue(DataRate(webRate)));
+            senderFactory.Set("PacketSize", UintegerValue(1024));
+        }
+        std::vector<Ipv4Address> webAddresses;
+        for (uint32_t i = numWalkUes; i < numUes; ++i)
+        {
+            webAddresses.push_back(ueIfaces.GetAddress(i));
+        }
+        sessionManager = CreateObject<SessionTrafficManager>();
+        sessionManager->SetAttribute("Port", UintegerValue(webPort));
+        sessionManager->SetAttribute("SessionRate", DoubleValue(sessionRate));
+        std::ostringstream duration;
+        duration << "ns3::ExponentialRandomVariable[Mean=" << sessionDuration << "]";
+        sessionManager->SetAttribute("SessionDuration", StringValue(duration.str()));
+        sessionManager->Setup(waypointUes, webAddresses, remoteHosts.Get(1), senderFactory);
+        sessionManager->Start(Seconds(2.0 - appTimeShift), appStopTime);
+    }
+    else
+    {
+        // OnOff (UDP) sinks on the waypoint UEs and OnOff apps on remoteHosts[1]
+        PacketSinkHelper webSinkHelper("ns3::UdpSocketFactory",
+                                       InetSocketAddress(Ipv4Address::GetAny(), webPort));
+        webSinks = webSinkHelper.Install(LocalNodes(waypointUes, systemId));
+        webSinks.Start(Seconds(1.5 - appTimeShift));
 
-        OnOffHelper onoff("ns3::UdpSocketFactory",
-                          InetSocketAddress(ueIfaces.GetAddress(i), webPort));
-        // make it continuously ON for web-like traffic
-        onoff.SetAttribute("OnTime", StringValue("ns3::ConstantRandomVariable[Constant=1]"));
-        onoff.SetAttribute("OffTime", StringValue("ns3::ConstantRandomVariable[Constant=0]"));
-        onoff.SetConstantRate(DataRate("5Mbps"));
-        onoff.SetAttribute("PacketSize", UintegerValue(1024));
-        ApplicationContainer apps = onoff.Install(remoteHosts.Get(1));
-        apps.Start(Seconds(2.0));
-        apps.Stop(Seconds(simTime));
+        if (webModel == "session")
+        {
+            // Page/object web sessions; --webRate paces the packet trains of each object
+            ObjectFactory sessionFactory;
+            sessionFactory.SetTypeId("ns3::WebSessionApplication");
+            sessionFactory.Set("DataRate", DataRateValue(DataRate(webRate)));
+            sessionFactory.Set("PacketSize", UintegerValue(1024));
+            for (uint32_t i = numWalkUes; i < numUes && remoteHostRank == systemId; ++i)
+            {
+                InetSocketAddress remote(ueIfaces.GetAddress(i), webPort);
+                sessionFactory.Set("Remote", AddressValue(remote));
+                Ptr<Application> app = sessionFactory.Create<Application>();
+                remoteHosts.Get(1)->AddApplication(app);
+                webApps.Add(app);
+            }
+        }
+        else
+        {
+            OnOffHelper onoff("ns3::UdpSocketFactory", Address());
+            // make it continuously ON for web-like traffic
+            onoff.SetAttribute("OnTime",
+                               StringValue("ns3::ConstantRandomVariable[Constant=1]"));
+            onoff.SetAttribute("OffTime",
+                               StringValue("ns3::ConstantRandomVariable[Constant=0]"));
+            onoff.SetConstantRate(DataRate(webRate));
+            onoff.SetAttribute("PacketSize", UintegerValue(1024));
+            for (uint32_t i = numWalkUes; i < numUes && remoteHostRank == systemId; ++i)
+            {
+                InetSocketAddress remote(ueIfaces.GetAddress(i), webPort);
+                onoff.SetAttribute("Remote", AddressValue(remote));
+                webApps.Add(onoff.Install(remoteHosts.Get(1)));
+            }
+        }
+        webApps.Start(Seconds(2.0 - appTimeShift));
+        webApps.Stop(appStopTime);
     }
 
     // ----------------------------
     // Flow monitor to collect metrics
+    // A single monitor: every extra InstallAll() adds another Ipv4FlowProbe per node,
+    // so each packet would be classified and accounted once per monitor.
     // ----------------------------
-    FlowMonitorHelper fmHelper;
-    Ptr<FlowMonitor> flowmon = fmHelper.InstallAll();
+    profiler.StartPhase("flowmon-install");
+    FlowMonitorHelper fm;
+    if (!flowmonHistograms)
+    {
+        // Single-bin histograms: FlowMonitor always fills them, this keeps each one at
+        // a constant size instead of one bin per ms of delay / byte of packet size
+        fm.SetMonitorAttribute("DelayBinWidth", DoubleValue(1e6));
+        fm.SetMonitorAttribute("JitterBinWidth", DoubleValue(1e6));
+        fm.SetMonitorAttribute("PacketSizeBinWidth", DoubleValue(1e6));
+        fm.SetMonitorAttribute("FlowInterruptionsBinWidth", DoubleValue(1e6));
+    }
+    Ptr<FlowMonitor> monitor;
+    if (flowmonScope == "ue-only")
+    {
+        monitor = fm.Install(LocalNodes(ues, systemId));
+    }
+    else if (flowmonScope == "remote-host-only")
+    {
+        monitor = fm.Install(LocalNodes(remoteHosts, systemId));
+    }
+    else if (flowmonScope == "pgw-only")
+    {
+        monitor = fm.Install(LocalNodes(NodeContainer(pgw), systemId));
+    }
+    else if (systemCount > 1)
+    {
+        monitor = fm.Install(LocalNodes(NodeContainer::GetGlobal(), systemId));
+    }
+    else
+    {
+        monitor = fm.InstallAll();
+    }
+
+    Ptr<Ipv4FlowClassifier> classifier = DynamicCast<Ipv4FlowClassifier>(fm.GetClassifier());
 
-    // Run simulation
-    Simulator::Stop(Seconds(simTime));
     // ----------------------------
-    // Flow monitor to collect metrics
+    // Warm-up snapshot: simulate EPC setup, RRC connection and bearer establishment once,
+    // then fork one process per replication from that state. Each replica switches to
+    // its own RngRun and re-seeds every random stream of the scenario, so the runs only
+    // share the warm-up. With --warmup=fast the attach has already been simulated.
     // ----------------------------
-    FlowMonitorHelper fm;
-    Ptr<FlowMonitor> monitor = fm.InstallAll();
+    if (snapshotReplications > 0)
+    {
+        if (!attachMonitor)
+        {
+            profiler.StartPhase("warm-up");
+            attachMonitor =
+                std::make_unique<AttachMonitor>(ueDevs, MakeCallback(&StopSimulation));
+            Simulator::Run();
+            NS_ABORT_MSG_UNLESS(attachMonitor->IsComplete(),
+                                "Not every UE attached within --simTime");
+        }
+        std::cout << "snapshot at " << Simulator::Now().As(Time::S) << ", forking "
+                  << snapshotReplications << " replications" << std::endl;
+
+        uint64_t baseRun = RngSeedManager::GetRun();
+        bool allSucceeded = true;
+        int replication =
+            SweepRunner::ForkReplications(snapshotReplications, snapshotJobs, allSucceeded);
+        if (replication < 0)
+        {
+            Simulator::Destroy();
+            return allSucceeded ? 0 : 1;
+        }
+
+        RngSeedManager::SetRun(baseRun + replication);
+        int64_t stream = 0;
+        stream += lteHelper->AssignStreams(enbDevs, stream);
+        stream += lteHelper->AssignStreams(ueDevs, stream);
+        if (populationMobility)
+        {
+            stream += populationMobility->AssignStreams(stream);
+        }
+        else
+        {
+            stream += ueMobility.AssignStreams(walkUes, stream);
+        }
+        for (const ApplicationContainer* apps : {&bulkApps, &webApps})
+        {
+            for (auto it = apps->Begin(); it != apps->End(); ++it)
+            {
+                stream += (*it)->AssignStreams(stream);
+            }
+        }
+        if (sessionManager)
+        {
+            stream += sessionManager->AssignStreams(stream);
+        }
+
+        std::string suffix = "-rep" + std::to_string(replication);
+        for (std::string* fileName : {&flowStatsFile,
+                                      &runSummaryFile,
+                                      &kpiFile,
+                                      &traceFile,
+                                      &kpiWindowFile,
+                                      &carrierStatsFile})
+        {
+            AddFileSuffix(*fileName, suffix);
+        }
+    }
+
+    std::unique_ptr<FlowStatsExporter> flowExporter;
+    if (flowStatsFormat != "xml")
+    {
+        flowExporter = std::make_unique<FlowStatsExporter>(
+            monitor,
+            classifier,
+            flowStatsFile,
+            FlowStatsExporter::ParseFormat(flowStatsFormat),
+            Seconds(flowStatsInterval));
+        flowExporter->Start();
+    }
+
+    // Created after a snapshot fork: the writer thread would not survive fork(). The UEs
+    // and eNBs it samples live on the radio rank
+    std::unique_ptr<KpiSampler> kpiSampler;
+    if (kpiInterval > 0 && systemId == radioRank)
+    {
+        ApplicationContainer ueSinks(bulkSinks);
+        ueSinks.Add(webSinks);
+        kpiSampler = std::make_unique<KpiSampler>(LocalDevices(ueDevs, systemId),
+                                                  LocalDevices(enbDevs, systemId),
+                                                  ueSinks,
+                                                  kpiFile,
+                                                  Seconds(kpiInterval),
+                                                  kpiRingCapacity);
+        kpiSampler->Start();
+    }
+
+    // Same for the publisher thread; the UE sinks live on the radio rank
+    std::unique_ptr<ProgressReporter> progressReporter;
+    if (!progress.empty() && systemId == radioRank)
+    {
+        ApplicationContainer ueSinks(bulkSinks);
+        ueSinks.Add(webSinks);
+        progressReporter = std::make_unique<ProgressReporter>(progress,
+                                                              ueSinks,
+                                                              Seconds(progressInterval / 1000),
+                                                              progressPeriod,
+                                                              Seconds(simTime));
+        progressReporter->Start();
+    }
+
+    std::unique_ptr<KpiAggregator> kpiAggregator;
+    std::unique_ptr<SteadyStateDetector> steadyState;
+    if (kpiWindow > 0)
+    {
+        kpiAggregator = std::make_unique<KpiAggregator>(
+            remoteHosts,
+            ueDevs,
+            enbDevs,
+            std::map<uint16_t, std::string>{{bulkPort, "bulk"}, {webPort, "web"}},
+            kpiWindowFile,
+            Seconds(kpiWindow),
+            kpiWindowSlices);
+        kpiAggregator->Start();
+    }
+    if (steadyStateTolerance > 0)
+    {
+        steadyState = std::make_unique<SteadyStateDetector>(*kpiAggregator,
+                                                            kpiWindowSlices,
+                                                            steadyStateTolerance,
+                                                            steadyStateBatches,
+                                                            Seconds(steadyStateMinTime));
+    }
+
+    // The radio side only exists on radioRank
+    std::unique_ptr<LteTraceCollector> traceCollector;
+    if (!traceLayers.empty() && systemId == radioRank)
+    {
+        traceCollector = std::make_unique<LteTraceCollector>(
+            traceLayers,
+            ueDevs,
+            LteTraceCollector::ParseIndexList(traceUes, ueDevs.GetN()),
+            enbDevs,
+            LteTraceCollector::ParseIndexList(traceEnbs, enbDevs.GetN()),
+            traceFile,
+            Seconds(traceWindow));
+        traceCollector->Start();
+    }
+    std::unique_ptr<CarrierThroughput> carrierThroughput;
+    if ((!carrierStatsFile.empty() || !runSummaryFile.empty()) && systemId == radioRank)
+    {
+        carrierThroughput = std::make_unique<CarrierThroughput>(enbDevs);
+    }
 
     // Run simulation
-    Simulator::Stop(Seconds(simTime));
+    profiler.StartPhase("run");
+    profiler.StartEventSampling(Seconds(profileSampleInterval));
     Simulator::Run();
+    // Earlier than simTime if the steady-state test stopped the run
+    double endTime = Simulator::Now().GetSeconds();
+    if (steadyState && steadyState->HasConverged())
+    {
+        std::cout << "steady state reached at " << endTime << " s" << std::endl;
+    }
+    if (packetPool)
+    {
+        std::cout << "packet pool: " << PooledAllocator::GetCarvedBytes() / (1 << 20)
+                  << " MiB carved, " << PooledAllocator::GetFallbacks() << " malloc fallbacks"
+                  << std::endl;
+    }
+
+    if (kpiSampler)
+    {
+        kpiSampler->Stop();
+    }
+    if (progressReporter)
+    {
+        progressReporter->Stop();
+    }
+    if (traceCollector)
+    {
+        traceCollector->Finish();
+    }
+    if (kpiAggregator)
+    {
+        kpiAggregator->Finish();
+    }
+
+    if (carrierThroughput && !carrierStatsFile.empty())
+    {
+        carrierThroughput->Write(carrierStatsFile);
+    }
 
-    monitor->CheckForLostPackets();
-    monitor->SerializeToXmlFile("flowmon-lte.xml", true, true);
+    profiler.StartPhase("flow-stats-output");
+    if (flowExporter)
+    {
+        flowExporter->Finish();
+    }
+    else
+    {
+        monitor->CheckForLostPackets();
+        monitor->SerializeToXmlFile(flowStatsFile, flowmonHistograms, flowmonHistograms);
+    }
+    if (!runSummaryFile.empty())
+    {
+        SweepRunner::Kpis kpis = SummarizeFlows(monitor, classifier, bulkPort, webPort);
+        if (bulkModel == "saturated")
+        {
+            // Saturated traffic bypasses the IP probes; count what the UE sinks received
+            uint64_t rxBytes = 0;
+            for (auto it = bulkSinks.Begin(); it != bulkSinks.End(); ++it)
+            {
+                rxBytes += DynamicCast<PacketSink>(*it)->GetTotalRx();
+            }
+            kpis["bulk_throughput_mbps"] = rxBytes * 8.0 / (endTime - bulkStartTime) / 1e6;
+        }
+        if (handover != "none")
+        {
+            kpis["handovers"] = handovers;
+        }
+        if (sessionManager)
+        {
+            kpis["web_sessions"] = sessionManager->GetSessions();
+            kpis["web_peak_active_sessions"] = sessionManager->GetPeakActiveSessions();
+        }
+        if (carrierThroughput)
+        {
+            carrierThroughput->AddKpis(kpis);
+        }
+        kpis["sim_time_s"] = endTime;
+        kpis["events"] = Simulator::GetEventCount();
+        SweepRunner::WriteRunSummary(runSummaryFile, kpis);
+    }
+    profiler.Stop();
+    profiler.Report(std::cout);
 
     Simulator::Destroy();
+#ifdef NS3_MPI
+    if (distributed)
+    {
+        MpiInterface::Disable();
+    }
+#endif
     return 0;
 }
 
+int
+main(int argc, char *argv[])
+{
+    return RunScenario(argc, argv);
+}
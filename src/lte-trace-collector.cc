@@ -0,0 +1,314 @@
+/* lte-trace-collector.cc
+ *
+ * See lte-trace-collector.h
+ */
+
+#include "lte-trace-collector.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/lte-enb-mac.h"
+#include "ns3/lte-enb-net-device.h"
+#include "ns3/lte-enb-phy.h"
+#include "ns3/lte-pdcp.h"
+#include "ns3/lte-rlc.h"
+#include "ns3/lte-ue-net-device.h"
+#include "ns3/lte-ue-phy.h"
+#include "ns3/lte-ue-rrc.h"
+#include "ns3/object-map.h"
+#include "ns3/pointer.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+NS_LOG_COMPONENT_DEFINE("LteTraceCollector");
+
+namespace ns3
+{
+
+LteTraceCollector::LteTraceCollector(const std::string& layers,
+                                     const NetDeviceContainer& ueDevices,
+                                     const std::vector<uint32_t>& ues,
+                                     const NetDeviceContainer& enbDevices,
+                                     const std::vector<uint32_t>& enbs,
+                                     const std::string& fileName,
+                                     Time window)
+    : m_ueDevices(ueDevices),
+      m_hookedBearers(ueDevices.GetN()),
+      m_window(window)
+{
+    NS_ABORT_MSG_IF(m_window <= Seconds(0), "Trace aggregation window must be positive");
+
+    std::fill(std::begin(m_enabled), std::end(m_enabled), false);
+    std::istringstream in(layers);
+    std::string layer;
+    while (std::getline(in, layer, ','))
+    {
+        if (layer == "phy")
+        {
+            m_enabled[PHY_DL] = m_enabled[PHY_UE] = true;
+        }
+        else if (layer == "mac")
+        {
+            m_enabled[MAC_DL] = true;
+        }
+        else if (layer == "rlc")
+        {
+            m_enabled[RLC_DL] = true;
+        }
+        else if (layer == "pdcp")
+        {
+            m_enabled[PDCP_DL] = true;
+        }
+        else
+        {
+            NS_FATAL_ERROR("Unknown trace layer " << layer << " (expected phy, mac, rlc, pdcp)");
+        }
+    }
+    m_acc[PHY_DL].resize(enbDevices.GetN());
+    m_acc[MAC_DL].resize(enbDevices.GetN());
+    m_acc[PHY_UE].resize(ueDevices.GetN());
+    m_acc[RLC_DL].resize(ueDevices.GetN());
+    m_acc[PDCP_DL].resize(ueDevices.GetN());
+
+    for (uint32_t i : enbs)
+    {
+        Ptr<LteEnbNetDevice> enb = DynamicCast<LteEnbNetDevice>(enbDevices.Get(i));
+        if (m_enabled[PHY_DL])
+        {
+            enb->GetPhy()->TraceConnectWithoutContext(
+                "DlPhyTransmission",
+                MakeBoundCallback(&LteTraceCollector::DlPhyTransmission, this, i));
+        }
+        if (m_enabled[MAC_DL])
+        {
+            enb->GetMac()->TraceConnectWithoutContext(
+                "DlScheduling",
+                MakeBoundCallback(&LteTraceCollector::DlScheduling, this, i));
+        }
+    }
+    for (uint32_t i : ues)
+    {
+        Ptr<LteUeNetDevice> ue = DynamicCast<LteUeNetDevice>(ueDevices.Get(i));
+        if (m_enabled[PHY_UE])
+        {
+            ue->GetPhy()->TraceConnectWithoutContext(
+                "ReportCurrentCellRsrpSinr",
+                MakeBoundCallback(&LteTraceCollector::RsrpSinr, this, i));
+        }
+        if (m_enabled[RLC_DL] || m_enabled[PDCP_DL])
+        {
+            // RLC/PDCP entities only exist once a bearer is set up (and are re-created
+            // on handover), so hook them as they appear
+            ue->GetRrc()->TraceConnectWithoutContext(
+                "DrbCreated",
+                MakeBoundCallback(&LteTraceCollector::DrbCreated, this, i));
+        }
+    }
+
+    m_out.open(fileName, std::ios::out | std::ios::binary);
+    NS_ABORT_MSG_UNLESS(m_out.is_open(), "Cannot open trace file " << fileName);
+    m_out.write("LTETRCE1", 8);
+}
+
+LteTraceCollector::~LteTraceCollector()
+{
+    Simulator::Cancel(m_event);
+}
+
+std::vector<uint32_t>
+LteTraceCollector::ParseIndexList(const std::string& spec, uint32_t n)
+{
+    std::vector<uint32_t> indices;
+    if (spec.empty() || spec == "all")
+    {
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            indices.push_back(i);
+        }
+        return indices;
+    }
+    std::istringstream in(spec);
+    std::string item;
+    while (std::getline(in, item, ','))
+    {
+        size_t dash = item.find('-');
+        uint32_t first = std::stoul(item.substr(0, dash));
+        uint32_t last = dash == std::string::npos ? first : std::stoul(item.substr(dash + 1));
+        NS_ABORT_MSG_IF(last < first || last >= n, "Bad index range " << item << " (0.." << n - 1 << ")");
+        for (uint32_t i = first; i <= last; ++i)
+        {
+            indices.push_back(i);
+        }
+    }
+    return indices;
+}
+
+void
+LteTraceCollector::Start()
+{
+    m_windowStart = Simulator::Now();
+    m_event = Simulator::Schedule(m_window, &LteTraceCollector::PeriodicFlush, this);
+}
+
+void
+LteTraceCollector::Finish()
+{
+    Simulator::Cancel(m_event);
+    Flush();
+    m_out.close();
+}
+
+void
+LteTraceCollector::PeriodicFlush()
+{
+    Flush();
+    m_event = Simulator::Schedule(m_window, &LteTraceCollector::PeriodicFlush, this);
+}
+
+void
+LteTraceCollector::Add(Layer layer, uint32_t entity, uint64_t bytes, double metric)
+{
+    Accumulator& acc = m_acc[layer][entity];
+    ++acc.count;
+    acc.bytes += bytes;
+    acc.metric += metric;
+}
+
+void
+LteTraceCollector::Flush()
+{
+    int64_t start = m_windowStart.GetNanoSeconds();
+    for (uint8_t layer = 0; layer < NUM_LAYERS; ++layer)
+    {
+        for (uint32_t entity = 0; entity < m_acc[layer].size(); ++entity)
+        {
+            Accumulator& acc = m_acc[layer][entity];
+            if (acc.count == 0)
+            {
+                continue;
+            }
+            const uint8_t reserved[3] = {0, 0, 0};
+            m_out.write(reinterpret_cast<const char*>(&start), sizeof(start));
+            m_out.write(reinterpret_cast<const char*>(&layer), sizeof(layer));
+            m_out.write(reinterpret_cast<const char*>(reserved), sizeof(reserved));
+            m_out.write(reinterpret_cast<const char*>(&entity), sizeof(entity));
+            m_out.write(reinterpret_cast<const char*>(&acc.count), sizeof(acc.count));
+            m_out.write(reinterpret_cast<const char*>(&acc.bytes), sizeof(acc.bytes));
+            m_out.write(reinterpret_cast<const char*>(&acc.metric), sizeof(acc.metric));
+            acc = Accumulator();
+        }
+    }
+    m_windowStart = Simulator::Now();
+}
+
+void
+LteTraceCollector::ConnectBearers(uint32_t ue)
+{
+    Ptr<LteUeRrc> rrc = DynamicCast<LteUeNetDevice>(m_ueDevices.Get(ue))->GetRrc();
+    ObjectMapValue drbs;
+    rrc->GetAttribute("DataRadioBearerMap", drbs);
+    // The entities of the current map replace the hooked list, so entities dropped by a
+    // handover or bearer release are let go; the old list still holds them during the
+    // comparison, so a new entity cannot share an old one's address
+    std::vector<Ptr<Object>>& hooked = m_hookedBearers[ue];
+    std::vector<Ptr<Object>> current;
+    auto isNew = [&hooked](Ptr<Object> entity) {
+        return std::find(hooked.begin(), hooked.end(), entity) == hooked.end();
+    };
+    for (auto it = drbs.Begin(); it != drbs.End(); ++it)
+    {
+        PointerValue rlcValue;
+        PointerValue pdcpValue;
+        it->second->GetAttribute("LteRlc", rlcValue);
+        it->second->GetAttribute("LtePdcp", pdcpValue);
+        Ptr<LteRlc> rlc = rlcValue.Get<LteRlc>();
+        Ptr<LtePdcp> pdcp = pdcpValue.Get<LtePdcp>();
+
+        if (m_enabled[RLC_DL] && rlc)
+        {
+            if (isNew(rlc))
+            {
+                rlc->TraceConnectWithoutContext(
+                    "RxPDU",
+                    MakeBoundCallback(&LteTraceCollector::RlcRx, this, ue));
+            }
+            current.push_back(rlc);
+        }
+        if (m_enabled[PDCP_DL] && pdcp)
+        {
+            if (isNew(pdcp))
+            {
+                pdcp->TraceConnectWithoutContext(
+                    "RxPDU",
+                    MakeBoundCallback(&LteTraceCollector::PdcpRx, this, ue));
+            }
+            current.push_back(pdcp);
+        }
+    }
+    hooked.swap(current);
+}
+
+void
+LteTraceCollector::DlPhyTransmission(LteTraceCollector* self,
+                                     uint32_t enb,
+                                     PhyTransmissionStatParameters params)
+{
+    self->Add(PHY_DL, enb, params.m_size, params.m_mcs);
+}
+
+void
+LteTraceCollector::RsrpSinr(LteTraceCollector* self,
+                            uint32_t ue,
+                            uint16_t /* cellId */,
+                            uint16_t /* rnti */,
+                            double /* rsrp */,
+                            double sinr,
+                            uint8_t /* componentCarrierId */)
+{
+    self->Add(PHY_UE, ue, 0, 10.0 * std::log10(sinr));
+}
+
+void
+LteTraceCollector::DlScheduling(LteTraceCollector* self, uint32_t enb, DlSchedulingCallbackInfo info)
+{
+    self->Add(MAC_DL, enb, info.sizeTb1 + info.sizeTb2, info.mcsTb1);
+}
+
+void
+LteTraceCollector::DrbCreated(LteTraceCollector* self,
+                              uint32_t ue,
+                              uint64_t /* imsi */,
+                              uint16_t /* cellId */,
+                              uint16_t /* rnti */,
+                              uint8_t /* lcid */)
+{
+    // The trace fires while the RRC is still filling in the bearer
+    Simulator::ScheduleNow(&LteTraceCollector::ConnectBearers, self, ue);
+}
+
+void
+LteTraceCollector::RlcRx(LteTraceCollector* self,
+                         uint32_t ue,
+                         uint16_t /* rnti */,
+                         uint8_t /* lcid */,
+                         uint32_t bytes,
+                         uint64_t delayNs)
+{
+    self->Add(RLC_DL, ue, bytes, delayNs * 1e-9);
+}
+
+void
+LteTraceCollector::PdcpRx(LteTraceCollector* self,
+                          uint32_t ue,
+                          uint16_t /* rnti */,
+                          uint8_t /* lcid */,
+                          uint32_t bytes,
+                          uint64_t delayNs)
+{
+    self->Add(PDCP_DL, ue, bytes, delayNs * 1e-9);
+}
+
+} // namespace ns3
@@ -0,0 +1,379 @@
+/* mac-scheduler-bench.cc
+ *
+ * See mac-scheduler-bench.h
+ */
+
+#include "mac-scheduler-bench.h"
+
+#include "pf-array-kernel.h"
+
+#include "ns3/boolean.h"
+#include "ns3/ff-mac-scheduler.h"
+#include "ns3/log.h"
+#include "ns3/lte-fr-no-op-algorithm.h"
+#include "ns3/object-factory.h"
+#include "ns3/random-variable-stream.h"
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <sstream>
+#include <vector>
+
+NS_LOG_COMPONENT_DEFINE("MacSchedulerBench");
+
+namespace ns3
+{
+
+static const uint32_t CQI_PERIOD = 5;        ///< TTIs between two reports of a UE
+static const uint32_t CQI_VARIANTS = 4;      ///< reports cycled through per UE
+static const uint32_t FULL_BUFFER = 1 << 20; ///< bytes
+static const uint8_t BENCH_LCID = 3;
+static const double PF_TIME_WINDOW = 99.0;   ///< TTIs, as PfFfMacScheduler
+
+/// Counts the UEs of each downlink allocation
+class BenchSchedSapUser : public FfMacSchedSapUser
+{
+  public:
+    void SchedDlConfigInd(const SchedDlConfigIndParameters& params) override
+    {
+        for (const BuildDataListElement_s& data : params.m_buildDataList)
+        {
+            m_scheduled.push_back(data.m_rnti);
+        }
+    }
+
+    void SchedUlConfigInd(const SchedUlConfigIndParameters& /* params */) override
+    {
+    }
+
+    std::vector<uint16_t> m_scheduled;
+};
+
+class BenchCschedSapUser : public FfMacCschedSapUser
+{
+  public:
+    void CschedCellConfigCnf(const CschedCellConfigCnfParameters& /* params */) override
+    {
+    }
+
+    void CschedUeConfigCnf(const CschedUeConfigCnfParameters& /* params */) override
+    {
+    }
+
+    void CschedLcConfigCnf(const CschedLcConfigCnfParameters& /* params */) override
+    {
+    }
+
+    void CschedLcReleaseCnf(const CschedLcReleaseCnfParameters& /* params */) override
+    {
+    }
+
+    void CschedUeReleaseCnf(const CschedUeReleaseCnfParameters& /* params */) override
+    {
+    }
+
+    void CschedUeConfigUpdateInd(const CschedUeConfigUpdateIndParameters& /* params */) override
+    {
+    }
+
+    void CschedCellConfigUpdateInd(const CschedCellConfigUpdateIndParameters& /* params */) override
+    {
+    }
+};
+
+/// Subband CQIs of every UE for each report variant; UE u has RNTI u + 1
+struct SyntheticChannel
+{
+    uint32_t numUes;
+    uint32_t numRbgs;
+    std::vector<uint8_t> subband;  ///< [(variant * numUes + ue) * numRbgs + rbg]
+    std::vector<uint8_t> wideband; ///< [variant * numUes + ue]
+
+    const uint8_t* Subband(uint32_t variant, uint32_t ue) const
+    {
+        return subband.data() + (variant * numUes + ue) * numRbgs;
+    }
+};
+
+static SyntheticChannel
+MakeChannel(uint32_t numUes, uint32_t numRbgs)
+{
+    Ptr<UniformRandomVariable> rv = CreateObject<UniformRandomVariable>();
+    rv->SetStream(1);
+    SyntheticChannel channel{numUes, numRbgs, {}, {}};
+    channel.subband.resize(CQI_VARIANTS * numUes * numRbgs);
+    channel.wideband.resize(CQI_VARIANTS * numUes);
+    std::vector<int> base(numUes);
+    for (uint32_t u = 0; u < numUes; ++u)
+    {
+        base[u] = rv->GetInteger(2, 15);
+    }
+    for (uint32_t v = 0; v < CQI_VARIANTS; ++v)
+    {
+        for (uint32_t u = 0; u < numUes; ++u)
+        {
+            // Frequency-selective around the UE's average channel
+            uint32_t sum = 0;
+            for (uint32_t r = 0; r < numRbgs; ++r)
+            {
+                int offset = static_cast<int>(rv->GetInteger(0, 4)) - 2;
+                int cqi = std::clamp(base[u] + offset, 1, 15);
+                channel.subband[(v * numUes + u) * numRbgs + r] = cqi;
+                sum += cqi;
+            }
+            channel.wideband[v * numUes + u] = (sum + numRbgs / 2) / numRbgs;
+        }
+    }
+    return channel;
+}
+
+static uint16_t
+SfnSf(uint32_t tti)
+{
+    uint32_t frame = 1 + (tti / 10) % 1024;
+    uint32_t subframe = 1 + tti % 10;
+    return ((0x3FF & frame) << 4) | (0xF & subframe);
+}
+
+static void
+RefillBuffer(FfMacSchedSapProvider* sched, uint16_t rnti)
+{
+    FfMacSchedSapProvider::SchedDlRlcBufferReqParameters buffer{};
+    buffer.m_rnti = rnti;
+    buffer.m_logicalChannelIdentity = BENCH_LCID;
+    buffer.m_rlcTransmissionQueueSize = FULL_BUFFER;
+    sched->SchedDlRlcBufferReq(buffer);
+}
+
+/// Run an ns-3 FfMacScheduler; returns the number of decisions, \p seconds the wall time
+static uint64_t
+RunScheduler(const std::string& typeName,
+             const SyntheticChannel& channel,
+             uint32_t ttis,
+             uint16_t dlBandwidth,
+             double& seconds)
+{
+    const uint32_t numUes = channel.numUes;
+
+    ObjectFactory factory;
+    factory.SetTypeId(typeName);
+    Ptr<FfMacScheduler> scheduler = factory.Create<FfMacScheduler>();
+    scheduler->SetAttributeFailSafe("HarqEnabled", BooleanValue(false));
+    Ptr<LteFfrAlgorithm> ffr = CreateObject<LteFrNoOpAlgorithm>();
+    ffr->SetDlBandwidth(dlBandwidth);
+    ffr->SetUlBandwidth(dlBandwidth);
+    scheduler->SetLteFfrSapProvider(ffr->GetLteFfrSapProvider());
+    ffr->SetLteFfrSapUser(scheduler->GetLteFfrSapUser());
+
+    BenchSchedSapUser schedUser;
+    BenchCschedSapUser cschedUser;
+    scheduler->SetFfMacSchedSapUser(&schedUser);
+    scheduler->SetFfMacCschedSapUser(&cschedUser);
+    ffr->Initialize();
+    scheduler->Initialize();
+    FfMacCschedSapProvider* csched = scheduler->GetFfMacCschedSapProvider();
+    FfMacSchedSapProvider* sched = scheduler->GetFfMacSchedSapProvider();
+
+    FfMacCschedSapProvider::CschedCellConfigReqParameters cell{};
+    cell.m_dlBandwidth = dlBandwidth;
+    cell.m_ulBandwidth = dlBandwidth;
+    csched->CschedCellConfigReq(cell);
+
+    // Reports as the MAC forwards them from the PHY: wideband P10 and subband A30
+    std::vector<CqiListElement_s> p10(CQI_VARIANTS * numUes);
+    std::vector<CqiListElement_s> a30(CQI_VARIANTS * numUes);
+    for (uint32_t v = 0; v < CQI_VARIANTS; ++v)
+    {
+        for (uint32_t u = 0; u < numUes; ++u)
+        {
+            CqiListElement_s& wideband = p10[v * numUes + u];
+            wideband.m_rnti = u + 1;
+            wideband.m_ri = 1;
+            wideband.m_cqiType = CqiListElement_s::P10;
+            wideband.m_wbCqi.push_back(channel.wideband[v * numUes + u]);
+            wideband.m_wbPmi = 0;
+
+            CqiListElement_s& subband = a30[v * numUes + u];
+            subband.m_rnti = u + 1;
+            subband.m_ri = 1;
+            subband.m_cqiType = CqiListElement_s::A30;
+            subband.m_wbCqi.push_back(channel.wideband[v * numUes + u]);
+            subband.m_wbPmi = 0;
+            const uint8_t* sb = channel.Subband(v, u);
+            for (uint32_t r = 0; r < channel.numRbgs; ++r)
+            {
+                HigherLayerSelected_s rbg;
+                rbg.m_sbPmi = 0;
+                rbg.m_sbCqi.push_back(sb[r]);
+                subband.m_sbMeasResult.m_higherLayerSelected.push_back(rbg);
+            }
+        }
+    }
+
+    FfMacSchedSapProvider::SchedDlCqiInfoReqParameters initialCqi;
+    initialCqi.m_sfnSf = SfnSf(0);
+    for (uint16_t u = 0; u < numUes; ++u)
+    {
+        FfMacCschedSapProvider::CschedUeConfigReqParameters ue{};
+        ue.m_rnti = u + 1;
+        ue.m_transmissionMode = 0; // SISO
+        csched->CschedUeConfigReq(ue);
+
+        LogicalChannelConfigListElement_s bearer{};
+        bearer.m_logicalChannelIdentity = BENCH_LCID;
+        bearer.m_logicalChannelGroup = 0;
+        bearer.m_direction = LogicalChannelConfigListElement_s::DIR_BOTH;
+        bearer.m_qosBearerType = LogicalChannelConfigListElement_s::QBT_NON_GBR;
+        bearer.m_qci = 9;
+        FfMacCschedSapProvider::CschedLcConfigReqParameters lc{};
+        lc.m_rnti = u + 1;
+        lc.m_reconfigureFlag = false;
+        lc.m_logicalChannelConfigList.push_back(bearer);
+        csched->CschedLcConfigReq(lc);
+
+        RefillBuffer(sched, u + 1);
+        initialCqi.m_cqiList.push_back(p10[u]);
+        initialCqi.m_cqiList.push_back(a30[u]);
+    }
+    sched->SchedDlCqiInfoReq(initialCqi);
+
+    uint64_t decisions = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t tti = 1; tti <= ttis; ++tti)
+    {
+        FfMacSchedSapProvider::SchedDlCqiInfoReqParameters cqi;
+        cqi.m_sfnSf = SfnSf(tti);
+        uint32_t variant = (tti / CQI_PERIOD) % CQI_VARIANTS;
+        for (uint32_t u = (CQI_PERIOD - tti % CQI_PERIOD) % CQI_PERIOD; u < numUes;
+             u += CQI_PERIOD)
+        {
+            cqi.m_cqiList.push_back(p10[variant * numUes + u]);
+            cqi.m_cqiList.push_back(a30[variant * numUes + u]);
+        }
+        if (!cqi.m_cqiList.empty())
+        {
+            sched->SchedDlCqiInfoReq(cqi);
+        }
+
+        FfMacSchedSapProvider::SchedDlTriggerReqParameters trigger;
+        trigger.m_sfnSf = SfnSf(tti);
+        sched->SchedDlTriggerReq(trigger);
+
+        decisions += schedUser.m_scheduled.size();
+        for (uint16_t rnti : schedUser.m_scheduled)
+        {
+            RefillBuffer(sched, rnti);
+        }
+        schedUser.m_scheduled.clear();
+    }
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    scheduler->Dispose();
+    ffr->Dispose();
+    return decisions;
+}
+
+/// Same inputs through PfArrayKernel
+static uint64_t
+RunKernel(const SyntheticChannel& channel, uint32_t ttis, uint16_t dlBandwidth, double& seconds)
+{
+    const uint32_t numUes = channel.numUes;
+    PfArrayKernel kernel(numUes, dlBandwidth, PF_TIME_WINDOW);
+    for (uint32_t u = 0; u < numUes; ++u)
+    {
+        kernel.SetCqi(u, channel.Subband(0, u));
+        kernel.SetBuffer(u, FULL_BUFFER);
+    }
+
+    std::vector<uint32_t> rbgOwner;
+    std::vector<uint32_t> scheduled;
+    uint64_t decisions = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t tti = 1; tti <= ttis; ++tti)
+    {
+        uint32_t variant = (tti / CQI_PERIOD) % CQI_VARIANTS;
+        for (uint32_t u = (CQI_PERIOD - tti % CQI_PERIOD) % CQI_PERIOD; u < numUes;
+             u += CQI_PERIOD)
+        {
+            kernel.SetCqi(u, channel.Subband(variant, u));
+        }
+        kernel.Schedule(rbgOwner, scheduled);
+        decisions += scheduled.size();
+        for (uint32_t u : scheduled)
+        {
+            kernel.SetBuffer(u, FULL_BUFFER);
+        }
+    }
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return decisions;
+}
+
+std::string
+MacSchedulerBench::GetSchedulerTypeName(const std::string& name)
+{
+    static const std::map<std::string, std::string> types = {
+        {"PF", "ns3::PfFfMacScheduler"},
+        {"RR", "ns3::RrFfMacScheduler"},
+        {"TD-MT", "ns3::TdMtFfMacScheduler"},
+        {"PSS", "ns3::PssFfMacScheduler"},
+        {"CQA", "ns3::CqaFfMacScheduler"},
+    };
+    auto it = types.find(name);
+    if (it == types.end())
+    {
+        NS_FATAL_ERROR("Unknown scheduler " << name << " (expected PF, RR, TD-MT, PSS or CQA)");
+    }
+    return it->second;
+}
+
+int
+MacSchedulerBench::Run(const std::string& schedulers,
+                       const std::string& ueCounts,
+                       uint32_t ttis,
+                       uint16_t dlBandwidth,
+                       std::ostream& os)
+{
+    std::vector<std::string> names;
+    std::istringstream schedulerList(schedulers == "all" ? "PF,RR,TD-MT,PSS,CQA,PF-array"
+                                                         : schedulers);
+    for (std::string name; std::getline(schedulerList, name, ',');)
+    {
+        if (name != "PF-array")
+        {
+            GetSchedulerTypeName(name); // aborts on unknown names
+        }
+        names.push_back(name);
+    }
+    std::vector<uint32_t> counts;
+    std::istringstream countList(ueCounts);
+    for (std::string count; std::getline(countList, count, ',');)
+    {
+        counts.push_back(std::stoul(count));
+        NS_ABORT_MSG_IF(counts.back() == 0 || counts.back() > 65000,
+                        "Benchmark UE counts must be within 1..65000");
+    }
+    NS_ABORT_MSG_IF(names.empty() || counts.empty() || ttis == 0,
+                    "--schedulerBench needs schedulers, UE counts and TTIs");
+
+    const uint32_t numRbgs = PfArrayKernel(1, dlBandwidth, PF_TIME_WINDOW).GetNumRbgs();
+    os << "scheduler,ues,ttis,decisions,decisions_per_s,ttis_per_s" << std::endl;
+    for (uint32_t numUes : counts)
+    {
+        SyntheticChannel channel = MakeChannel(numUes, numRbgs);
+        for (const std::string& name : names)
+        {
+            double seconds = 0.0;
+            uint64_t decisions =
+                name == "PF-array"
+                    ? RunKernel(channel, ttis, dlBandwidth, seconds)
+                    : RunScheduler(GetSchedulerTypeName(name), channel, ttis, dlBandwidth, seconds);
+            seconds = std::max(seconds, 1e-9);
+            os << name << "," << numUes << "," << ttis << "," << decisions << ","
+               << decisions / seconds << "," << ttis / seconds << std::endl;
+        }
+    }
+    return 0;
+}
+
+} // namespace ns3
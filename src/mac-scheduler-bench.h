@@ -0,0 +1,51 @@
+/* mac-scheduler-bench.h
+ *
+ * Downlink MAC scheduler micro-benchmark (--schedulerBench) and the --scheduler names.
+ *
+ * Each scheduler is instantiated outside any LteEnbMac, wired to a no-op FFR algorithm
+ * and to SAP users that only count, and configured with one non-GBR bearer per UE. Every
+ * TTI the benchmark delivers a staggered 5 ms periodic CQI report (wideband P10 plus
+ * subband A30, drawn once from a fixed stream so every scheduler sees the same channel),
+ * triggers the downlink allocation and refills the RLC queue of every allocated UE, so
+ * all UEs stay backlogged. The wall time of these SAP calls gives the scheduling
+ * decisions (UEs granted a transport block) and TTIs per second. HARQ is disabled; the
+ * benchmark has no PHY to return feedback.
+ *
+ * "PF-array" runs PfArrayKernel on the same inputs, for comparison with "PF".
+ */
+
+#ifndef MAC_SCHEDULER_BENCH_H
+#define MAC_SCHEDULER_BENCH_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace ns3
+{
+
+class MacSchedulerBench
+{
+  public:
+    /// FfMacScheduler TypeId name of a --scheduler value (PF, RR, TD-MT, PSS, CQA)
+    static std::string GetSchedulerTypeName(const std::string& name);
+
+    /**
+     * Benchmark every scheduler of \p schedulers ("PF,RR,...,PF-array" or "all") for
+     * every UE count of \p ueCounts ("10,100,1000") and print one CSV row per pair to
+     * \p os.
+     *
+     * \param ttis TTIs simulated per pair
+     * \param dlBandwidth downlink bandwidth in resource blocks
+     * \return 0
+     */
+    static int Run(const std::string& schedulers,
+                   const std::string& ueCounts,
+                   uint32_t ttis,
+                   uint16_t dlBandwidth,
+                   std::ostream& os);
+};
+
+} // namespace ns3
+
+#endif /* MAC_SCHEDULER_BENCH_H */
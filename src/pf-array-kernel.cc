@@ -0,0 +1,160 @@
+/* pf-array-kernel.cc
+ *
+ * See pf-array-kernel.h
+ */
+
+#include "pf-array-kernel.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/lte-amc.h"
+
+#include <algorithm>
+
+NS_LOG_COMPONENT_DEFINE("PfArrayKernel");
+
+namespace ns3
+{
+
+/// RBG size of a downlink bandwidth, as GetRbgSize() of the ns-3 FF schedulers
+static uint32_t
+RbgSize(uint16_t dlBandwidth)
+{
+    static const uint16_t type0AllocationRbg[4] = {10, 26, 63, 110};
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        if (dlBandwidth < type0AllocationRbg[i])
+        {
+            return i + 1;
+        }
+    }
+    NS_FATAL_ERROR("Unsupported downlink bandwidth " << dlBandwidth);
+    return 0;
+}
+
+PfArrayKernel::PfArrayKernel(uint32_t numUes, uint16_t dlBandwidth, double timeWindow)
+    : m_numUes(numUes),
+      m_timeWindow(timeWindow)
+{
+    NS_ABORT_MSG_IF(timeWindow < 1.0, "PF time window must be at least one TTI");
+    const uint32_t rbgSize = RbgSize(dlBandwidth);
+    m_numRbgs = dlBandwidth / rbgSize;
+
+    Ptr<LteAmc> amc = CreateObject<LteAmc>();
+    m_rbgRate.assign(16, 0.0f);
+    m_tbBytes.assign(16 * (m_numRbgs + 1), 0);
+    for (int cqi = 1; cqi < 16; ++cqi)
+    {
+        int mcs = amc->GetMcsFromCqi(cqi);
+        m_rbgRate[cqi] = (amc->GetDlTbSizeFromMcs(mcs, rbgSize) / 8) / 0.001;
+        for (uint32_t rbgs = 1; rbgs <= m_numRbgs; ++rbgs)
+        {
+            m_tbBytes[cqi * (m_numRbgs + 1) + rbgs] =
+                amc->GetDlTbSizeFromMcs(mcs, rbgs * rbgSize) / 8;
+        }
+    }
+
+    m_sbCqi.assign(m_numRbgs * numUes, 0);
+    m_buffer.assign(numUes, 0);
+    m_avgThroughput.assign(numUes, 1.0); // PfFfMacScheduler's initial average
+    m_weight.resize(numUes);
+    m_metric.resize(numUes);
+    m_rbgsWon.assign(numUes, 0);
+    m_worstCqi.resize(numUes);
+    m_ttiBytes.assign(numUes, 0);
+}
+
+uint32_t
+PfArrayKernel::GetNumRbgs() const
+{
+    return m_numRbgs;
+}
+
+void
+PfArrayKernel::SetCqi(uint32_t ue, const uint8_t* subbandCqi)
+{
+    for (uint32_t rbg = 0; rbg < m_numRbgs; ++rbg)
+    {
+        m_sbCqi[rbg * m_numUes + ue] = std::min<uint8_t>(subbandCqi[rbg], 15);
+    }
+}
+
+void
+PfArrayKernel::SetBuffer(uint32_t ue, uint32_t bytes)
+{
+    m_buffer[ue] = bytes;
+}
+
+uint64_t
+PfArrayKernel::Schedule(std::vector<uint32_t>& rbgOwner, std::vector<uint32_t>& scheduled)
+{
+    const uint32_t n = m_numUes;
+    rbgOwner.assign(m_numRbgs, NO_UE);
+    scheduled.clear();
+
+    // A zero weight keeps UEs without data from winning any RBG
+    for (uint32_t u = 0; u < n; ++u)
+    {
+        m_weight[u] = m_buffer[u] > 0 ? static_cast<float>(1.0 / m_avgThroughput[u]) : 0.0f;
+    }
+
+    const float* rate = m_rbgRate.data();
+    const float* weight = m_weight.data();
+    float* metric = m_metric.data();
+    for (uint32_t rbg = 0; rbg < m_numRbgs; ++rbg)
+    {
+        const uint8_t* cqi = m_sbCqi.data() + rbg * n;
+        // Branch-free over contiguous arrays; the argmax runs separately
+        for (uint32_t u = 0; u < n; ++u)
+        {
+            metric[u] = rate[cqi[u]] * weight[u];
+        }
+        uint32_t winner = NO_UE;
+        float best = 0.0f;
+        for (uint32_t u = 0; u < n; ++u)
+        {
+            if (metric[u] > best)
+            {
+                best = metric[u];
+                winner = u;
+            }
+        }
+        if (winner == NO_UE)
+        {
+            continue;
+        }
+        rbgOwner[rbg] = winner;
+        if (m_rbgsWon[winner]++ == 0)
+        {
+            scheduled.push_back(winner);
+            m_worstCqi[winner] = cqi[winner];
+        }
+        else
+        {
+            m_worstCqi[winner] = std::min(m_worstCqi[winner], cqi[winner]);
+        }
+    }
+
+    uint64_t total = 0;
+    for (uint32_t u : scheduled)
+    {
+        uint32_t bytes = m_tbBytes[m_worstCqi[u] * (m_numRbgs + 1) + m_rbgsWon[u]];
+        m_ttiBytes[u] = bytes;
+        m_buffer[u] -= std::min(m_buffer[u], bytes);
+        m_rbgsWon[u] = 0;
+        total += bytes;
+    }
+
+    const double alpha = 1.0 / m_timeWindow;
+    for (uint32_t u = 0; u < n; ++u)
+    {
+        m_avgThroughput[u] = (1.0 - alpha) * m_avgThroughput[u] + alpha * (m_ttiBytes[u] / 0.001);
+    }
+    for (uint32_t u : scheduled)
+    {
+        m_ttiBytes[u] = 0;
+    }
+    return total;
+}
+
+} // namespace ns3
@@ -0,0 +1,79 @@
+/* pf-array-kernel.h
+ *
+ * Downlink proportional-fair allocation over contiguous per-UE arrays.
+ *
+ * PfFfMacScheduler evaluates its metric per RBG and UE through std::map lookups (flow
+ * statistics, RLC buffers, subband CQI) and an LteAmc table walk per candidate. This
+ * kernel computes the same allocation from dense arrays indexed by UE: the RBG rate of
+ * every CQI and the transport block size of every (CQI, RBG count) are tabulated once,
+ * subband CQIs are stored RBG-major (the UEs of one RBG are adjacent) and the 1 / average
+ * throughput weight of every UE is computed once per TTI, so the inner loop over UEs is a
+ * table lookup and a multiply into a contiguous metric array followed by an argmax.
+ *
+ * Semantics follow PfFfMacScheduler without HARQ: each RBG goes to the UE with data and
+ * the highest rate(subband CQI) / average throughput, a UE's transport block uses the MCS
+ * of the worst subband CQI among its RBGs, and every UE's average is updated with the
+ * exponential TimeWindow filter after the TTI. A single logical channel per UE.
+ */
+
+#ifndef PF_ARRAY_KERNEL_H
+#define PF_ARRAY_KERNEL_H
+
+#include <cstdint>
+#include <vector>
+
+namespace ns3
+{
+
+class PfArrayKernel
+{
+  public:
+    /// rbgOwner value of an RBG nobody could use
+    static constexpr uint32_t NO_UE = UINT32_MAX;
+
+    /**
+     * \param numUes number of UEs
+     * \param dlBandwidth downlink bandwidth in resource blocks
+     * \param timeWindow averaging window of the throughput filter, in TTIs
+     */
+    PfArrayKernel(uint32_t numUes, uint16_t dlBandwidth, double timeWindow);
+
+    uint32_t GetNumRbgs() const;
+
+    /// Subband CQIs of \p ue, GetNumRbgs() values in 0..15
+    void SetCqi(uint32_t ue, const uint8_t* subbandCqi);
+    /// RLC transmission queue of \p ue in bytes
+    void SetBuffer(uint32_t ue, uint32_t bytes);
+
+    /**
+     * Allocate one TTI.
+     *
+     * \param [out] rbgOwner UE index per RBG, NO_UE if unallocated
+     * \param [out] scheduled UEs that got at least one RBG, in order of their first RBG
+     * \return transport block bytes handed out
+     */
+    uint64_t Schedule(std::vector<uint32_t>& rbgOwner, std::vector<uint32_t>& scheduled);
+
+  private:
+    uint32_t m_numUes;
+    uint32_t m_numRbgs;
+    double m_timeWindow;
+
+    std::vector<float> m_rbgRate;    ///< [cqi] bytes/s of one RBG
+    std::vector<uint32_t> m_tbBytes; ///< [cqi * (numRbgs + 1) + rbgs] transport block size
+
+    std::vector<uint8_t> m_sbCqi; ///< [rbg * numUes + ue]
+    std::vector<uint32_t> m_buffer;
+    std::vector<double> m_avgThroughput; ///< bytes/s
+
+    // Per-TTI scratch, kept to avoid reallocations
+    std::vector<float> m_weight; ///< 1 / average throughput, 0 without data
+    std::vector<float> m_metric;
+    std::vector<uint16_t> m_rbgsWon;
+    std::vector<uint8_t> m_worstCqi;
+    std::vector<uint32_t> m_ttiBytes;
+};
+
+} // namespace ns3
+
+#endif /* PF_ARRAY_KERNEL_H */
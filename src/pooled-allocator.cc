@@ -0,0 +1,312 @@
+/* pooled-allocator.cc
+ *
+ * See pooled-allocator.h
+ *
+ * Deliberately free of ns-3 logging and asserts: everything here runs inside operator new.
+ */
+
+#include "pooled-allocator.h"
+
+#include <sys/mman.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace ns3
+{
+
+static const uint32_t NUM_CLASSES = 44;
+static const size_t MAX_POOLED = 64 * 1024;
+static const size_t REFILL_BYTES = 64 * 1024; ///< carved per refill, at least one block
+
+/// Slice of the region owned by one size class
+struct ClassArena
+{
+    std::atomic<uintptr_t> next;
+    uintptr_t begin;
+    uintptr_t end;
+};
+
+static uintptr_t g_base = 0;  ///< region start, 0 while disabled
+static uintptr_t g_limit = 0; ///< region end
+static size_t g_span = 0;     ///< bytes per class slice
+static ClassArena g_arenas[NUM_CLASSES];
+static std::atomic<bool> g_enabled{false};
+static std::atomic<uint64_t> g_fallbacks{0};
+
+// Trivially destructible, so it is usable until the very end of every thread
+static thread_local void* t_freeList[NUM_CLASSES];
+
+static inline uint32_t
+ClassOf(size_t size)
+{
+    if (size <= 64)
+    {
+        return size <= 16 ? 0 : (size - 1) >> 4;
+    }
+    // (2^k, 2^(k+1)] split in four classes of 2^(k-2)
+    uint32_t k = 63 - __builtin_clzll(size - 1);
+    uint32_t sub = ((size - 1) >> (k - 2)) & 3;
+    return 4 + (k - 6) * 4 + sub;
+}
+
+static inline size_t
+ClassSize(uint32_t c)
+{
+    if (c < 4)
+    {
+        return 16 * (c + 1);
+    }
+    uint32_t k = (c - 4) / 4 + 6;
+    uint32_t sub = (c - 4) % 4;
+    return (size_t(1) << k) + (sub + 1) * (size_t(1) << (k - 2));
+}
+
+/// Carve a batch for class \p c: one block is returned, the rest go on the free list
+static void*
+Refill(uint32_t c)
+{
+    const size_t size = ClassSize(c);
+    const size_t count = REFILL_BYTES > size ? REFILL_BYTES / size : 1;
+    ClassArena& arena = g_arenas[c];
+    uintptr_t first = arena.next.fetch_add(count * size, std::memory_order_relaxed);
+    if (first + count * size > arena.end)
+    {
+        g_fallbacks.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    for (size_t i = count - 1; i > 0; --i)
+    {
+        void* block = reinterpret_cast<void*>(first + i * size);
+        *static_cast<void**>(block) = t_freeList[c];
+        t_freeList[c] = block;
+    }
+    return reinterpret_cast<void*>(first);
+}
+
+static inline void*
+Allocate(size_t size)
+{
+    if (g_enabled.load(std::memory_order_relaxed) && size <= MAX_POOLED)
+    {
+        uint32_t c = ClassOf(size);
+        void* block = t_freeList[c];
+        if (block)
+        {
+            t_freeList[c] = *static_cast<void**>(block);
+            return block;
+        }
+        block = Refill(c);
+        if (block)
+        {
+            return block;
+        }
+    }
+    return std::malloc(size ? size : 1);
+}
+
+static inline void
+Free(void* p)
+{
+    uintptr_t address = reinterpret_cast<uintptr_t>(p);
+    if (address >= g_base && address < g_limit)
+    {
+        uint32_t c = (address - g_base) / g_span;
+        *static_cast<void**>(p) = t_freeList[c];
+        t_freeList[c] = p;
+        return;
+    }
+    std::free(p);
+}
+
+static void*
+AllocateOrThrow(size_t size)
+{
+    void* p = Allocate(size);
+    if (!p)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+static void*
+AllocateAligned(size_t size, std::align_val_t alignment)
+{
+    size_t align = static_cast<size_t>(alignment);
+    if (align <= 16)
+    {
+        return Allocate(size); // every class size is a multiple of 16
+    }
+    // aligned_alloc wants a multiple of the alignment
+    return std::aligned_alloc(align, (size + align - 1) / align * align);
+}
+
+void
+PooledAllocator::Enable(size_t reserveBytes)
+{
+    if (g_enabled.load())
+    {
+        return;
+    }
+    size_t span = (reserveBytes / NUM_CLASSES) & ~size_t(4095);
+    if (span < MAX_POOLED)
+    {
+        return;
+    }
+    void* region = mmap(nullptr,
+                        span * NUM_CLASSES,
+                        PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+                        -1,
+                        0);
+    if (region == MAP_FAILED)
+    {
+        return;
+    }
+    g_span = span;
+    g_base = reinterpret_cast<uintptr_t>(region);
+    g_limit = g_base + span * NUM_CLASSES;
+    for (uint32_t c = 0; c < NUM_CLASSES; ++c)
+    {
+        g_arenas[c].begin = g_base + c * span;
+        g_arenas[c].end = g_arenas[c].begin + span;
+        g_arenas[c].next.store(g_arenas[c].begin, std::memory_order_relaxed);
+    }
+    g_enabled.store(true, std::memory_order_release);
+}
+
+bool
+PooledAllocator::IsEnabled()
+{
+    return g_enabled.load();
+}
+
+uint64_t
+PooledAllocator::GetCarvedBytes()
+{
+    if (!g_enabled.load())
+    {
+        return 0;
+    }
+    uint64_t carved = 0;
+    for (const ClassArena& arena : g_arenas)
+    {
+        uintptr_t next = arena.next.load(std::memory_order_relaxed);
+        carved += (next < arena.end ? next : arena.end) - arena.begin;
+    }
+    return carved;
+}
+
+uint64_t
+PooledAllocator::GetFallbacks()
+{
+    return g_fallbacks.load(std::memory_order_relaxed);
+}
+
+} // namespace ns3
+
+// Replaceable global allocation functions; they are linked into the program, so the
+// ns-3 shared libraries resolve to them too
+
+void*
+operator new(size_t size)
+{
+    return ns3::AllocateOrThrow(size);
+}
+
+void*
+operator new[](size_t size)
+{
+    return ns3::AllocateOrThrow(size);
+}
+
+void*
+operator new(size_t size, const std::nothrow_t& /* tag */) noexcept
+{
+    return ns3::Allocate(size);
+}
+
+void*
+operator new[](size_t size, const std::nothrow_t& /* tag */) noexcept
+{
+    return ns3::Allocate(size);
+}
+
+void*
+operator new(size_t size, std::align_val_t alignment)
+{
+    void* p = ns3::AllocateAligned(size, alignment);
+    if (!p)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void*
+operator new[](size_t size, std::align_val_t alignment)
+{
+    return operator new(size, alignment);
+}
+
+void
+operator delete(void* p) noexcept
+{
+    ns3::Free(p);
+}
+
+void
+operator delete[](void* p) noexcept
+{
+    ns3::Free(p);
+}
+
+void
+operator delete(void* p, size_t /* size */) noexcept
+{
+    ns3::Free(p);
+}
+
+void
+operator delete[](void* p, size_t /* size */) noexcept
+{
+    ns3::Free(p);
+}
+
+void
+operator delete(void* p, const std::nothrow_t& /* tag */) noexcept
+{
+    ns3::Free(p);
+}
+
+void
+operator delete[](void* p, const std::nothrow_t& /* tag */) noexcept
+{
+    ns3::Free(p);
+}
+
+void
+operator delete(void* p, std::align_val_t /* alignment */) noexcept
+{
+    ns3::Free(p);
+}
+
+void
+operator delete[](void* p, std::align_val_t /* alignment */) noexcept
+{
+    ns3::Free(p);
+}
+
+void
+operator delete(void* p, size_t /* size */, std::align_val_t /* alignment */) noexcept
+{
+    ns3::Free(p);
+}
+
+void
+operator delete[](void* p, size_t /* size */, std::align_val_t /* alignment */) noexcept
+{
+    ns3::Free(p);
+}
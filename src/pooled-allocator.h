@@ -0,0 +1,47 @@
+/* pooled-allocator.h
+ *
+ * Opt-in size-class pool behind the global operator new / delete (--packetPool).
+ *
+ * Every packet on the remote host -> PGW -> eNB -> UE path costs several small heap
+ * blocks: the Packet itself, its Buffer data (payload plus headers, ~1.1 kB for a 1024 B
+ * OnOff packet), byte / packet tag lists, metadata and the events that move it. ns-3
+ * allocates all of them with operator new, from the applications, the point-to-point
+ * devices and the EPC GTP-U tunnels alike, so replacing the global operator in this
+ * program pools the whole data path without touching the ns-3 modules.
+ *
+ * Once Enable() has run, requests up to 64 KiB are rounded to one of 44 size classes
+ * (16 B steps up to 64 B, then four classes per power of two) and served from a
+ * thread-local free list; an empty list is refilled with a batch carved from the class's
+ * own slice of one reserved, lazily committed mmap region, and freed blocks go back on
+ * the freeing thread's list. The class of a block follows from its address, so blocks
+ * carry no header. After the first packets of every size have been through the path the
+ * steady state performs no malloc / free at all. Larger requests, requests made before
+ * Enable() and requests for a class whose slice is exhausted go to malloc; pooled memory
+ * is never returned to the system.
+ */
+
+#ifndef POOLED_ALLOCATOR_H
+#define POOLED_ALLOCATOR_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ns3
+{
+
+class PooledAllocator
+{
+  public:
+    /// Reserve \p reserveBytes of address space and start pooling; only the first call counts
+    static void Enable(size_t reserveBytes);
+    static bool IsEnabled();
+
+    /// Bytes carved from the region so far (pages actually committed, at most)
+    static uint64_t GetCarvedBytes();
+    /// Refills that fell back to malloc because a class's slice was exhausted
+    static uint64_t GetFallbacks();
+};
+
+} // namespace ns3
+
+#endif /* POOLED_ALLOCATOR_H */
@@ -0,0 +1,402 @@
+/* population-mobility.cc
+ *
+ * See population-mobility.h
+ */
+
+#include "population-mobility.h"
+
+#include "ns3/abort.h"
+#include "ns3/double.h"
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+NS_LOG_COMPONENT_DEFINE("PopulationMobility");
+
+namespace ns3
+{
+
+NS_OBJECT_ENSURE_REGISTERED(PopulationMobilityManager);
+NS_OBJECT_ENSURE_REGISTERED(PopulationMobilityModel);
+
+TypeId
+PopulationMobilityManager::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::PopulationMobilityManager")
+            .SetParent<Object>()
+            .AddConstructor<PopulationMobilityManager>()
+            .AddAttribute("Step",
+                          "Simulated time between two batch updates of the population",
+                          TimeValue(MilliSeconds(100)),
+                          MakeTimeAccessor(&PopulationMobilityManager::m_step),
+                          MakeTimeChecker(MilliSeconds(1)))
+            .AddAttribute("Bounds",
+                          "Area the random-walk UEs move and reflect in",
+                          RectangleValue(Rectangle(0.0, 100.0, 0.0, 100.0)),
+                          MakeRectangleAccessor(&PopulationMobilityManager::m_bounds),
+                          MakeRectangleChecker())
+            .AddAttribute("Speed",
+                          "Random-walk speed in m/s",
+                          DoubleValue(5.0),
+                          MakeDoubleAccessor(&PopulationMobilityManager::m_speed),
+                          MakeDoubleChecker<double>(0.0))
+            .AddAttribute("Distance",
+                          "Meters a random-walk UE travels before picking a new direction",
+                          DoubleValue(1.0),
+                          MakeDoubleAccessor(&PopulationMobilityManager::m_distance),
+                          MakeDoubleChecker<double>(0.0));
+    return tid;
+}
+
+PopulationMobilityManager::PopulationMobilityManager()
+    : m_uniform(CreateObject<UniformRandomVariable>())
+{
+}
+
+PopulationMobilityManager::~PopulationMobilityManager()
+{
+}
+
+void
+PopulationMobilityManager::DoDispose()
+{
+    Simulator::Cancel(m_event);
+    m_uniform = nullptr;
+    Object::DoDispose();
+}
+
+void
+PopulationMobilityManager::State::Push(double px, double py)
+{
+    x.push_back(px);
+    y.push_back(py);
+    vx.push_back(0.0);
+    vy.push_back(0.0);
+}
+
+void
+PopulationMobilityManager::Aggregate(Ptr<Node> node, Kind kind, uint32_t index)
+{
+    NS_ABORT_MSG_IF(node->GetObject<MobilityModel>(),
+                    "Node " << node->GetId() << " already has a mobility model");
+    Ptr<PopulationMobilityModel> proxy = CreateObject<PopulationMobilityModel>();
+    proxy->Bind(this, kind, index);
+    node->AggregateObject(proxy);
+}
+
+void
+PopulationMobilityManager::InstallRandomWalk(const NodeContainer& nodes)
+{
+    for (uint32_t n = 0; n < nodes.GetN(); ++n)
+    {
+        uint32_t i = m_walk.x.size();
+        m_walk.Push(m_uniform->GetValue(m_bounds.xMin, m_bounds.xMax),
+                    m_uniform->GetValue(m_bounds.yMin, m_bounds.yMax));
+        m_walkLeft.push_back(0.0);
+        NewDirection(i);
+        Aggregate(nodes.Get(n), WALK, i);
+    }
+}
+
+uint32_t
+PopulationMobilityManager::InstallWaypoint(Ptr<Node> node)
+{
+    uint32_t i = m_waypoints.size();
+    m_waypoint.Push(0.0, 0.0);
+    m_segmentEnd.push_back(std::numeric_limits<double>::infinity());
+    m_waypoints.emplace_back();
+    Aggregate(node, WAYPOINT, i);
+    return i;
+}
+
+void
+PopulationMobilityManager::AddWaypoint(uint32_t index, const Waypoint& waypoint)
+{
+    WaypointQueue& queue = m_waypoints[index];
+    NS_ABORT_MSG_IF(!queue.points.empty() && waypoint.time < queue.points.back().time,
+                    "Waypoints of UE " << index << " must be added in time order");
+    queue.points.push_back(waypoint);
+    // The stepped state may predate this waypoint: answer queries exactly until the
+    // next step picks it up
+    m_segmentEnd[index] = std::min(m_segmentEnd[index], m_lastStep.GetSeconds());
+}
+
+uint32_t
+PopulationMobilityManager::GetPendingWaypoints(uint32_t index) const
+{
+    const WaypointQueue& queue = m_waypoints[index];
+    return queue.points.size() - queue.head;
+}
+
+void
+PopulationMobilityManager::Start()
+{
+    m_lastStep = Simulator::Now();
+    StepWaypoints(m_lastStep);
+    m_event = Simulator::Schedule(m_step, &PopulationMobilityManager::Step, this);
+}
+
+int64_t
+PopulationMobilityManager::AssignStreams(int64_t stream)
+{
+    m_uniform->SetStream(stream);
+    return 1;
+}
+
+void
+PopulationMobilityManager::Step()
+{
+    Time now = Simulator::Now();
+    StepWalk((now - m_lastStep).GetSeconds());
+    m_lastStep = now;
+    StepWaypoints(now);
+    m_event = Simulator::Schedule(m_step, &PopulationMobilityManager::Step, this);
+}
+
+void
+PopulationMobilityManager::NewDirection(uint32_t i)
+{
+    double angle = m_uniform->GetValue(0.0, 2.0 * M_PI);
+    m_walk.vx[i] = m_speed * std::cos(angle);
+    m_walk.vy[i] = m_speed * std::sin(angle);
+    m_walkLeft[i] = m_distance;
+}
+
+void
+PopulationMobilityManager::StepWalk(double dt)
+{
+    const size_t n = m_walk.x.size();
+    double* x = m_walk.x.data();
+    double* y = m_walk.y.data();
+    double* vx = m_walk.vx.data();
+    double* vy = m_walk.vy.data();
+    double* left = m_walkLeft.data();
+    const double xMin = m_bounds.xMin;
+    const double xMax = m_bounds.xMax;
+    const double yMin = m_bounds.yMin;
+    const double yMax = m_bounds.yMax;
+    const double travelled = m_speed * dt;
+
+    // Branch-free so the compiler can vectorize it; one reflection per step is enough
+    // while Speed * Step is below the area side
+    for (size_t i = 0; i < n; ++i)
+    {
+        double nx = x[i] + vx[i] * dt;
+        double ny = y[i] + vy[i] * dt;
+        bool outX = nx < xMin || nx > xMax;
+        bool outY = ny < yMin || ny > yMax;
+        nx = nx < xMin ? 2.0 * xMin - nx : (nx > xMax ? 2.0 * xMax - nx : nx);
+        ny = ny < yMin ? 2.0 * yMin - ny : (ny > yMax ? 2.0 * yMax - ny : ny);
+        x[i] = nx;
+        y[i] = ny;
+        vx[i] = outX ? -vx[i] : vx[i];
+        vy[i] = outY ? -vy[i] : vy[i];
+        left[i] -= travelled;
+    }
+
+    // Direction changes draw random numbers and stay scalar
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (left[i] <= 0.0)
+        {
+            NewDirection(i);
+        }
+    }
+}
+
+void
+PopulationMobilityManager::Interpolate(uint32_t i,
+                                       double t,
+                                       Vector& position,
+                                       Vector& velocity) const
+{
+    const std::vector<Waypoint>& points = m_waypoints[i].points;
+    uint32_t k = m_waypoints[i].head;
+    if (k >= points.size())
+    {
+        position = Vector(m_waypoint.x[i], m_waypoint.y[i], 0.0);
+        velocity = Vector(0.0, 0.0, 0.0);
+        return;
+    }
+    while (k + 1 < points.size() && points[k + 1].time.GetSeconds() <= t)
+    {
+        ++k;
+    }
+    const Waypoint& from = points[k];
+    if (k + 1 == points.size() || t < from.time.GetSeconds())
+    {
+        // Before the first or after the last waypoint
+        position = from.position;
+        velocity = Vector(0.0, 0.0, 0.0);
+        return;
+    }
+    const Waypoint& to = points[k + 1];
+    double span = (to.time - from.time).GetSeconds();
+    velocity = Vector((to.position.x - from.position.x) / span,
+                      (to.position.y - from.position.y) / span,
+                      (to.position.z - from.position.z) / span);
+    double elapsed = t - from.time.GetSeconds();
+    position = Vector(from.position.x + velocity.x * elapsed,
+                      from.position.y + velocity.y * elapsed,
+                      from.position.z + velocity.z * elapsed);
+}
+
+void
+PopulationMobilityManager::StepWaypoints(Time now)
+{
+    const double t = now.GetSeconds();
+    for (uint32_t i = 0; i < m_waypoints.size(); ++i)
+    {
+        WaypointQueue& queue = m_waypoints[i];
+        if (queue.head >= queue.points.size())
+        {
+            m_segmentEnd[i] = std::numeric_limits<double>::infinity();
+            continue;
+        }
+        while (queue.head + 1 < queue.points.size() &&
+               queue.points[queue.head + 1].time <= now)
+        {
+            ++queue.head;
+        }
+        // Release passed waypoints once they make up half of the queue
+        if (queue.head >= 16 && 2 * queue.head >= queue.points.size())
+        {
+            queue.points.erase(queue.points.begin(), queue.points.begin() + queue.head);
+            queue.head = 0;
+        }
+
+        Vector position;
+        Vector velocity;
+        Interpolate(i, t, position, velocity);
+        m_waypoint.x[i] = position.x;
+        m_waypoint.y[i] = position.y;
+        m_waypoint.vx[i] = velocity.x;
+        m_waypoint.vy[i] = velocity.y;
+
+        const Waypoint& from = queue.points[queue.head];
+        if (t < from.time.GetSeconds())
+        {
+            m_segmentEnd[i] = from.time.GetSeconds();
+        }
+        else if (queue.head + 1 < queue.points.size())
+        {
+            m_segmentEnd[i] = queue.points[queue.head + 1].time.GetSeconds();
+        }
+        else
+        {
+            m_segmentEnd[i] = std::numeric_limits<double>::infinity();
+        }
+    }
+}
+
+Vector
+PopulationMobilityManager::GetPosition(Kind kind, uint32_t index) const
+{
+    Time now = Simulator::Now();
+    double dt = (now - m_lastStep).GetSeconds();
+    if (kind == WALK)
+    {
+        // Clamped: the reflection is only applied at the next step
+        return Vector(std::clamp(m_walk.x[index] + m_walk.vx[index] * dt,
+                                 m_bounds.xMin,
+                                 m_bounds.xMax),
+                      std::clamp(m_walk.y[index] + m_walk.vy[index] * dt,
+                                 m_bounds.yMin,
+                                 m_bounds.yMax),
+                      0.0);
+    }
+    if (now.GetSeconds() >= m_segmentEnd[index])
+    {
+        Vector position;
+        Vector velocity;
+        Interpolate(index, now.GetSeconds(), position, velocity);
+        return position;
+    }
+    return Vector(m_waypoint.x[index] + m_waypoint.vx[index] * dt,
+                  m_waypoint.y[index] + m_waypoint.vy[index] * dt,
+                  0.0);
+}
+
+Vector
+PopulationMobilityManager::GetVelocity(Kind kind, uint32_t index) const
+{
+    if (kind == WALK)
+    {
+        return Vector(m_walk.vx[index], m_walk.vy[index], 0.0);
+    }
+    if (Simulator::Now().GetSeconds() >= m_segmentEnd[index])
+    {
+        Vector position;
+        Vector velocity;
+        Interpolate(index, Simulator::Now().GetSeconds(), position, velocity);
+        return velocity;
+    }
+    return Vector(m_waypoint.vx[index], m_waypoint.vy[index], 0.0);
+}
+
+void
+PopulationMobilityManager::SetPosition(Kind kind, uint32_t index, const Vector& position)
+{
+    // Stored relative to the last step so that extrapolation returns it right now
+    double dt = (Simulator::Now() - m_lastStep).GetSeconds();
+    State& state = kind == WALK ? m_walk : m_waypoint;
+    state.x[index] = position.x - state.vx[index] * dt;
+    state.y[index] = position.y - state.vy[index] * dt;
+}
+
+TypeId
+PopulationMobilityModel::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::PopulationMobilityModel")
+                            .SetParent<MobilityModel>()
+                            .AddConstructor<PopulationMobilityModel>();
+    return tid;
+}
+
+PopulationMobilityModel::PopulationMobilityModel()
+    : m_kind(PopulationMobilityManager::WALK),
+      m_index(0)
+{
+}
+
+void
+PopulationMobilityModel::Bind(Ptr<PopulationMobilityManager> manager,
+                              PopulationMobilityManager::Kind kind,
+                              uint32_t index)
+{
+    m_manager = manager;
+    m_kind = kind;
+    m_index = index;
+}
+
+void
+PopulationMobilityModel::DoDispose()
+{
+    m_manager = nullptr;
+    MobilityModel::DoDispose();
+}
+
+Vector
+PopulationMobilityModel::DoGetPosition() const
+{
+    return m_manager->GetPosition(m_kind, m_index);
+}
+
+void
+PopulationMobilityModel::DoSetPosition(const Vector& position)
+{
+    m_manager->SetPosition(m_kind, m_index, position);
+}
+
+Vector
+PopulationMobilityModel::DoGetVelocity() const
+{
+    return m_manager->GetVelocity(m_kind, m_index);
+}
+
+} // namespace ns3
@@ -0,0 +1,147 @@
+/* population-mobility.h
+ *
+ * Mobility for large UE populations (--mobilityModel=population).
+ *
+ * A RandomWalk2dMobilityModel is a full Object with its own random variables and one
+ * event per direction change; a WaypointMobilityModel keeps its waypoints in a per-UE
+ * deque. PopulationMobilityManager instead keeps the state of every UE in
+ * structure-of-arrays form (x, y, vx, vy in contiguous vectors) and advances the whole
+ * population with one event per Step. Each node only aggregates a PopulationMobilityModel,
+ * a two-field proxy that answers GetPosition() by extrapolating the UE's last stepped
+ * position with its velocity, so queries cost two multiply-adds and no event.
+ *
+ * Behaviours carried over:
+ *  - random walk: constant Speed, a new uniform direction every Distance meters travelled,
+ *    reflection on the Bounds rectangle (direction changes are quantized to the Step)
+ *  - waypoints: linear motion between time-stamped waypoints; the UE holds the first
+ *    waypoint before its time and the last one after it. Waypoints can be appended while
+ *    the simulation runs, consumed ones are released.
+ *
+ * Course-change traces are not fired; nothing in the LTE models listens to them.
+ */
+
+#ifndef POPULATION_MOBILITY_H
+#define POPULATION_MOBILITY_H
+
+#include "ns3/event-id.h"
+#include "ns3/mobility-model.h"
+#include "ns3/node-container.h"
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/rectangle.h"
+#include "ns3/waypoint.h"
+
+#include <vector>
+
+namespace ns3
+{
+
+class PopulationMobilityManager : public Object
+{
+  public:
+    static TypeId GetTypeId();
+
+    PopulationMobilityManager();
+    ~PopulationMobilityManager() override;
+
+    /// Random-walk UEs at uniform positions inside Bounds
+    void InstallRandomWalk(const NodeContainer& nodes);
+    /// Waypoint UE without waypoints yet; returns the index to pass to AddWaypoint()
+    uint32_t InstallWaypoint(Ptr<Node> node);
+    /// Append a waypoint; times must not decrease for a given UE
+    void AddWaypoint(uint32_t index, const Waypoint& waypoint);
+    /// Waypoints of a UE not yet passed (including the current segment's end)
+    uint32_t GetPendingWaypoints(uint32_t index) const;
+
+    /// Schedule the first batch step
+    void Start();
+
+    int64_t AssignStreams(int64_t stream);
+
+    /// Which state arrays a proxy refers to
+    enum Kind : uint8_t
+    {
+        WALK,
+        WAYPOINT
+    };
+
+    Vector GetPosition(Kind kind, uint32_t index) const;
+    Vector GetVelocity(Kind kind, uint32_t index) const;
+    void SetPosition(Kind kind, uint32_t index, const Vector& position);
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    /// Positions and velocities at m_lastStep, one array per coordinate
+    struct State
+    {
+        std::vector<double> x;
+        std::vector<double> y;
+        std::vector<double> vx;
+        std::vector<double> vy;
+
+        void Push(double px, double py);
+    };
+
+    /// Pending waypoints of one UE; points[head] is the current segment's start
+    struct WaypointQueue
+    {
+        std::vector<Waypoint> points;
+        uint32_t head = 0;
+    };
+
+    void Step();
+    void StepWalk(double dt);
+    void StepWaypoints(Time now);
+    void NewDirection(uint32_t i);
+    /// Exact waypoint position/velocity at \p t, scanning from the queue head
+    void Interpolate(uint32_t i, double t, Vector& position, Vector& velocity) const;
+    void Aggregate(Ptr<Node> node, Kind kind, uint32_t index);
+
+    Time m_step;
+    Rectangle m_bounds;
+    double m_speed;
+    double m_distance;
+    Ptr<UniformRandomVariable> m_uniform;
+
+    State m_walk;
+    std::vector<double> m_walkLeft; ///< meters until the next direction change
+    State m_waypoint;
+    std::vector<double> m_segmentEnd; ///< seconds; extrapolation is exact until then
+    std::vector<WaypointQueue> m_waypoints;
+
+    Time m_lastStep;
+    EventId m_event;
+};
+
+/**
+ * Position proxy aggregated to each node by PopulationMobilityManager.
+ */
+class PopulationMobilityModel : public MobilityModel
+{
+  public:
+    static TypeId GetTypeId();
+
+    PopulationMobilityModel();
+    void Bind(Ptr<PopulationMobilityManager> manager,
+              PopulationMobilityManager::Kind kind,
+              uint32_t index);
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    Vector DoGetPosition() const override;
+    void DoSetPosition(const Vector& position) override;
+    Vector DoGetVelocity() const override;
+
+    Ptr<PopulationMobilityManager> m_manager;
+    PopulationMobilityManager::Kind m_kind;
+    uint32_t m_index;
+};
+
+} // namespace ns3
+
+#endif /* POPULATION_MOBILITY_H */
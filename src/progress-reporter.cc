@@ -0,0 +1,439 @@
+/* progress-reporter.cc
+ *
+ * See progress-reporter.h
+ */
+
+#include "progress-reporter.h"
+
+#include "scenario-profiler.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iomanip>
+#include <iostream>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+NS_LOG_COMPONENT_DEFINE("ProgressReporter");
+
+namespace ns3
+{
+
+/// Longest sleep of the publisher, so Stop() and scrapes are never kept waiting longer
+static const int MAX_POLL_MS = 100;
+
+ProgressReporter::ProgressReporter(const std::string& target,
+                                   const ApplicationContainer& sinks,
+                                   Time interval,
+                                   double periodSeconds,
+                                   Time stopTime)
+    : m_kind(STDERR),
+      m_port(0),
+      m_interval(interval),
+      m_period(periodSeconds),
+      m_stopSeconds(stopTime.GetSeconds()),
+      m_sequence(0),
+      m_simSeconds(0),
+      m_events(0),
+      m_rxBytes(0),
+      m_listenFd(-1),
+      m_report{{0, 0, 0}, 0, 0, 0, -1, 0, 0},
+      m_running(false)
+{
+    NS_ABORT_MSG_IF(m_interval <= Seconds(0), "Progress reading interval must be positive");
+    NS_ABORT_MSG_IF(m_period <= 0, "Progress publication period must be positive");
+
+    if (target.rfind("unix:", 0) == 0)
+    {
+        m_kind = UNIX_SOCKET;
+        m_path = target.substr(5);
+        NS_ABORT_MSG_IF(m_path.empty() || m_path.size() >= sizeof(sockaddr_un::sun_path),
+                        "Bad UNIX socket path in --progress=" << target);
+    }
+    else if (target.rfind("prometheus:", 0) == 0)
+    {
+        m_kind = PROMETHEUS;
+        std::string endpoint = target.substr(11);
+        size_t colon = endpoint.rfind(':');
+        m_address = colon == std::string::npos ? "127.0.0.1" : endpoint.substr(0, colon);
+        std::string port = colon == std::string::npos ? endpoint : endpoint.substr(colon + 1);
+        char* end = nullptr;
+        unsigned long value = std::strtoul(port.c_str(), &end, 10);
+        NS_ABORT_MSG_IF(port.empty() || *end != '\0' || value == 0 || value > 65535,
+                        "Bad port in --progress=" << target);
+        m_port = static_cast<uint16_t>(value);
+    }
+    else
+    {
+        NS_ABORT_MSG_UNLESS(target == "stderr",
+                            "Unknown --progress=" << target
+                                                  << " (expected stderr, unix:<path> or "
+                                                     "prometheus:[<address>:]<port>)");
+    }
+
+    for (auto it = sinks.Begin(); it != sinks.End(); ++it)
+    {
+        if (Ptr<PacketSink> sink = DynamicCast<PacketSink>(*it))
+        {
+            m_sinks.push_back(sink);
+        }
+    }
+}
+
+ProgressReporter::~ProgressReporter()
+{
+    Stop();
+}
+
+void
+ProgressReporter::Start()
+{
+    NS_ABORT_MSG_IF(m_running, "ProgressReporter already started");
+    if (m_kind == UNIX_SOCKET)
+    {
+        m_listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, m_path.c_str(), sizeof(addr.sun_path) - 1);
+        unlink(m_path.c_str()); // left over by an earlier run
+        NS_ABORT_MSG_IF(m_listenFd < 0 ||
+                            bind(m_listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) ||
+                            listen(m_listenFd, 8),
+                        "Cannot listen on " << m_path << ": " << std::strerror(errno));
+    }
+    else if (m_kind == PROMETHEUS)
+    {
+        m_listenFd = socket(AF_INET, SOCK_STREAM, 0);
+        int reuse = 1;
+        setsockopt(m_listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(m_port);
+        NS_ABORT_MSG_IF(inet_pton(AF_INET, m_address.c_str(), &addr.sin_addr) != 1,
+                        "Bad IPv4 address " << m_address << " for the progress endpoint");
+        NS_ABORT_MSG_IF(m_listenFd < 0 ||
+                            bind(m_listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) ||
+                            listen(m_listenFd, 8),
+                        "Cannot listen on " << m_address << ":" << m_port << ": "
+                                            << std::strerror(errno));
+    }
+    if (m_listenFd >= 0)
+    {
+        fcntl(m_listenFd, F_SETFL, fcntl(m_listenFd, F_GETFL) | O_NONBLOCK);
+    }
+
+    Sample(); // the publisher starts from the current state
+    m_running = true;
+    m_publisher = std::thread(&ProgressReporter::PublisherLoop, this);
+}
+
+void
+ProgressReporter::Stop()
+{
+    if (m_publisher.joinable())
+    {
+        Sample(); // the final publication shows where the run ended
+        Simulator::Cancel(m_event);
+        m_running = false;
+        m_publisher.join();
+    }
+    Simulator::Cancel(m_event);
+    for (int fd : m_clients)
+    {
+        close(fd);
+    }
+    m_clients.clear();
+    if (m_listenFd >= 0)
+    {
+        close(m_listenFd);
+        m_listenFd = -1;
+        if (m_kind == UNIX_SOCKET)
+        {
+            unlink(m_path.c_str());
+        }
+    }
+}
+
+void
+ProgressReporter::Sample()
+{
+    uint64_t rx = 0;
+    for (const Ptr<PacketSink>& sink : m_sinks)
+    {
+        rx += sink->GetTotalRx();
+    }
+    // Seqlock writer: the publisher retries a Load() that overlaps this
+    uint64_t sequence = m_sequence.load(std::memory_order_relaxed);
+    m_sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_simSeconds.store(Simulator::Now().GetSeconds(), std::memory_order_relaxed);
+    m_events.store(Simulator::GetEventCount(), std::memory_order_relaxed);
+    m_rxBytes.store(rx, std::memory_order_relaxed);
+    m_sequence.store(sequence + 2, std::memory_order_release);
+
+    m_event = Simulator::Schedule(m_interval, &ProgressReporter::Sample, this);
+}
+
+ProgressReporter::Reading
+ProgressReporter::Load() const
+{
+    Reading reading;
+    uint64_t before;
+    uint64_t after;
+    do
+    {
+        before = m_sequence.load(std::memory_order_acquire);
+        reading.simSeconds = m_simSeconds.load(std::memory_order_relaxed);
+        reading.events = m_events.load(std::memory_order_relaxed);
+        reading.rxBytes = m_rxBytes.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = m_sequence.load(std::memory_order_relaxed);
+    } while ((before & 1) || before != after);
+    return reading;
+}
+
+void
+ProgressReporter::PublisherLoop()
+{
+    Reading previous = Load();
+    Clock::time_point previousWall = Clock::now();
+    m_lastAdvance = previousWall;
+    auto period = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(m_period));
+    Clock::time_point next = previousWall + period;
+
+    while (true)
+    {
+        // Read the flag before ticking: Stop() stores the final reading before clearing it
+        bool running = m_running.load(std::memory_order_acquire);
+        Clock::time_point now = Clock::now();
+        if (!running || now >= next)
+        {
+            std::chrono::duration<double> wall = now - previousWall;
+            m_report = Tick(previous, wall.count());
+            Publish(m_report);
+            previous = m_report.reading;
+            previousWall = now;
+            next = std::max(next + period, now);
+            if (!running)
+            {
+                return;
+            }
+            continue;
+        }
+
+        auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(next - now);
+        int timeout = std::min<int>(MAX_POLL_MS, wait.count() + 1);
+        if (m_listenFd < 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(timeout));
+            continue;
+        }
+        pollfd listener{m_listenFd, POLLIN, 0};
+        if (poll(&listener, 1, timeout) > 0 && (listener.revents & POLLIN))
+        {
+            if (m_kind == UNIX_SOCKET)
+            {
+                AcceptClients();
+            }
+            else
+            {
+                ServeScrape();
+            }
+        }
+    }
+}
+
+ProgressReporter::Report
+ProgressReporter::Tick(const Reading& previous, double wallSeconds)
+{
+    Report report;
+    report.reading = Load();
+    Clock::time_point now = Clock::now();
+    double simAdvance = report.reading.simSeconds - previous.simSeconds;
+    if (simAdvance > 0)
+    {
+        m_lastAdvance = now;
+    }
+    report.realTimeFactor = wallSeconds > 0 ? simAdvance / wallSeconds : 0;
+    report.eventRate = wallSeconds > 0 ? (report.reading.events - previous.events) / wallSeconds
+                                       : 0;
+    report.throughputMbps =
+        simAdvance > 0 ? (report.reading.rxBytes - previous.rxBytes) * 8.0 / simAdvance / 1e6
+                       : 0;
+    double remaining = std::max(0.0, m_stopSeconds - report.reading.simSeconds);
+    report.etaSeconds = report.realTimeFactor > 0 ? remaining / report.realTimeFactor : -1;
+    report.staleSeconds = std::chrono::duration<double>(now - m_lastAdvance).count();
+    report.rssKb = ScenarioProfiler::GetCurrentRssKb();
+    return report;
+}
+
+void
+ProgressReporter::Publish(const Report& report)
+{
+    if (m_kind == STDERR)
+    {
+        std::cerr << FormatLine(report) << std::endl;
+    }
+    else if (m_kind == UNIX_SOCKET)
+    {
+        AcceptClients();
+        std::string line = FormatJson(report) + "\n";
+        auto lagging = [&line](int fd) {
+            ssize_t sent = send(fd, line.data(), line.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+            if (sent == static_cast<ssize_t>(line.size()))
+            {
+                return false;
+            }
+            close(fd); // gone, or its socket buffer is full
+            return true;
+        };
+        m_clients.erase(std::remove_if(m_clients.begin(), m_clients.end(), lagging),
+                        m_clients.end());
+    }
+    // PROMETHEUS: m_report is served on the next scrape
+}
+
+void
+ProgressReporter::AcceptClients()
+{
+    int fd;
+    while ((fd = accept(m_listenFd, nullptr, nullptr)) >= 0)
+    {
+        m_clients.push_back(fd);
+    }
+}
+
+void
+ProgressReporter::ServeScrape()
+{
+    int fd = accept(m_listenFd, nullptr, nullptr);
+    if (fd < 0)
+    {
+        return;
+    }
+    // Whatever the request, the answer is the same; read it so closing does not reset
+    timeval timeout{1, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    std::string request;
+    char buffer[1024];
+    ssize_t n;
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192 &&
+           (n = recv(fd, buffer, sizeof(buffer), 0)) > 0)
+    {
+        request.append(buffer, n);
+    }
+    std::string body = FormatPrometheus(m_report);
+    std::ostringstream response;
+    response << "HTTP/1.0 200 OK\r\n"
+             << "Content-Type: text/plain; version=0.0.4\r\n"
+             << "Content-Length: " << body.size() << "\r\n"
+             << "Connection: close\r\n\r\n"
+             << body;
+    std::string data = response.str();
+    send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+    close(fd);
+}
+
+std::string
+ProgressReporter::FormatLine(const Report& report) const
+{
+    const Reading& r = report.reading;
+    std::ostringstream os;
+    os << std::fixed << std::setprecision(2) << "progress: " << r.simSeconds << "/"
+       << m_stopSeconds << " s simulated ("
+       << (m_stopSeconds > 0 ? 100.0 * r.simSeconds / m_stopSeconds : 100.0) << "%), "
+       << std::setprecision(3) << report.realTimeFactor << "x real time, ETA ";
+    if (report.etaSeconds < 0)
+    {
+        os << "unknown";
+    }
+    else
+    {
+        os << std::setprecision(0) << report.etaSeconds << " s";
+    }
+    os << std::setprecision(0) << ", " << r.events << " events (" << report.eventRate
+       << "/s), RSS " << report.rssKb / 1024 << " MiB, " << std::setprecision(1)
+       << report.throughputMbps << " Mbps";
+    if (report.staleSeconds >= m_period)
+    {
+        os << std::setprecision(0) << ", no progress for " << report.staleSeconds << " s";
+    }
+    return os.str();
+}
+
+std::string
+ProgressReporter::FormatJson(const Report& report) const
+{
+    const Reading& r = report.reading;
+    std::ostringstream os;
+    os << std::setprecision(9) << "{\"sim_time_s\": " << r.simSeconds
+       << ", \"stop_time_s\": " << m_stopSeconds << ", \"events\": " << r.events
+       << ", \"rx_bytes\": " << r.rxBytes << ", \"real_time_factor\": " << report.realTimeFactor
+       << ", \"events_per_s\": " << report.eventRate
+       << ", \"throughput_mbps\": " << report.throughputMbps
+       << ", \"eta_s\": " << report.etaSeconds << ", \"stale_s\": " << report.staleSeconds
+       << ", \"rss_kb\": " << report.rssKb << "}";
+    return os.str();
+}
+
+std::string
+ProgressReporter::FormatPrometheus(const Report& report) const
+{
+    struct Metric
+    {
+        const char* name;
+        const char* type;
+        const char* help;
+        double value;
+    };
+
+    const Reading& r = report.reading;
+    const Metric metrics[] = {
+        {"lte_sim_simulated_seconds", "gauge", "Simulated time reached", r.simSeconds},
+        {"lte_sim_stop_seconds", "gauge", "Simulated time the run stops at", m_stopSeconds},
+        {"lte_sim_events_total", "counter", "Scheduler events executed", double(r.events)},
+        {"lte_sim_rx_bytes_total", "counter", "Bytes received by the UE sinks", double(r.rxBytes)},
+        {"lte_sim_real_time_factor",
+         "gauge",
+         "Simulated seconds per wall-clock second",
+         report.realTimeFactor},
+        {"lte_sim_events_per_second", "gauge", "Events per wall-clock second", report.eventRate},
+        {"lte_sim_throughput_mbps",
+         "gauge",
+         "Aggregate UE throughput per simulated second",
+         report.throughputMbps},
+        {"lte_sim_eta_seconds",
+         "gauge",
+         "Wall-clock seconds to the stop time (-1 = unknown)",
+         report.etaSeconds},
+        {"lte_sim_stale_seconds",
+         "gauge",
+         "Wall-clock seconds since the simulated time last advanced",
+         report.staleSeconds},
+        {"lte_sim_resident_bytes", "gauge", "Resident set size", report.rssKb * 1024.0},
+    };
+
+    std::ostringstream os;
+    os << std::setprecision(12);
+    for (const Metric& m : metrics)
+    {
+        os << "# HELP " << m.name << " " << m.help << "\n"
+           << "# TYPE " << m.name << " " << m.type << "\n"
+           << m.name << " " << m.value << "\n";
+    }
+    return os.str();
+}
+
+} // namespace ns3
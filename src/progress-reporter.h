@@ -0,0 +1,130 @@
+/* progress-reporter.h
+ *
+ * Live progress of a long run (--progress).
+ *
+ * Every interval of simulated time a periodic event stores the simulated time, the
+ * executed event count and the bytes received by the UE sinks into a few atomics (a
+ * seqlock keeps them consistent); that is all the simulator thread does. A background
+ * thread wakes up every wall-clock period, derives the real-time factor, the event rate,
+ * the aggregate throughput and the time to completion from two consecutive readings,
+ * adds the resident set size and publishes the result to one target:
+ *  - stderr: one human-readable line per period
+ *  - unix:<path>: a UNIX stream socket; every connected client gets one JSON object per
+ *    line and period (e.g. socat - UNIX-CONNECT:<path>), clients that lag are dropped
+ *  - prometheus:[<address>:]<port>: an HTTP endpoint (default address 127.0.0.1) serving
+ *    the latest period in the Prometheus text format on any path
+ * The reading also tells how long ago the simulated time last advanced, so a stalled
+ * run shows up as a growing "no progress" age instead of silence. The time to
+ * completion assumes the recent real-time factor holds and the run lasts to the target
+ * time (an early steady-state stop ends it sooner). Bytes of sessions created on demand
+ * are not part of the throughput.
+ */
+
+#ifndef PROGRESS_REPORTER_H
+#define PROGRESS_REPORTER_H
+
+#include "ns3/application-container.h"
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/packet-sink.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ns3
+{
+
+class ProgressReporter
+{
+  public:
+    /**
+     * \param target "stderr", "unix:<path>" or "prometheus:[<address>:]<port>"
+     * \param sinks PacketSinks whose received bytes make up the throughput
+     * \param interval simulated time between two readings
+     * \param periodSeconds wall-clock seconds between two publications
+     * \param stopTime simulated time the run is expected to reach
+     */
+    ProgressReporter(const std::string& target,
+                     const ApplicationContainer& sinks,
+                     Time interval,
+                     double periodSeconds,
+                     Time stopTime);
+    ~ProgressReporter();
+
+    /// Open the target, start the publisher thread and schedule the first reading
+    void Start();
+    /// Cancel the readings, publish once more, join the publisher and close the target
+    void Stop();
+
+  private:
+    enum Kind
+    {
+        STDERR,
+        UNIX_SOCKET,
+        PROMETHEUS
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    /// What the simulator thread shares with the publisher
+    struct Reading
+    {
+        double simSeconds;
+        uint64_t events;
+        uint64_t rxBytes;
+    };
+
+    /// One publication, derived by the publisher from two readings
+    struct Report
+    {
+        Reading reading;
+        double realTimeFactor; ///< simulated / wall seconds over the last period
+        double eventRate;      ///< events per wall second over the last period
+        double throughputMbps; ///< per simulated second over the last period
+        double etaSeconds;     ///< wall seconds to the stop time, < 0 if unknown
+        double staleSeconds;   ///< wall seconds since the simulated time last advanced
+        uint64_t rssKb;
+    };
+
+    void Sample();
+    Reading Load() const;
+    void PublisherLoop();
+    Report Tick(const Reading& previous, double wallSeconds);
+    void Publish(const Report& report);
+    void AcceptClients();
+    void ServeScrape();
+    std::string FormatLine(const Report& report) const;
+    std::string FormatJson(const Report& report) const;
+    std::string FormatPrometheus(const Report& report) const;
+
+    Kind m_kind;
+    std::string m_path;    ///< UNIX_SOCKET
+    std::string m_address; ///< PROMETHEUS
+    uint16_t m_port;       ///< PROMETHEUS
+    std::vector<Ptr<PacketSink>> m_sinks;
+    Time m_interval;
+    double m_period;
+    double m_stopSeconds;
+    EventId m_event;
+
+    // Written by Sample() only
+    std::atomic<uint64_t> m_sequence; ///< odd while a reading is being stored
+    std::atomic<double> m_simSeconds;
+    std::atomic<uint64_t> m_events;
+    std::atomic<uint64_t> m_rxBytes;
+
+    int m_listenFd;
+    std::vector<int> m_clients; ///< publisher thread only
+    Report m_report;            ///< publisher thread only
+    Clock::time_point m_lastAdvance;
+    std::thread m_publisher;
+    std::atomic<bool> m_running;
+};
+
+} // namespace ns3
+
+#endif /* PROGRESS_REPORTER_H */
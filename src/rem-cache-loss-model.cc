@@ -0,0 +1,390 @@
+/* rem-cache-loss-model.cc
+ *
+ * See rem-cache-loss-model.h
+ */
+
+#include "rem-cache-loss-model.h"
+
+#include "ns3/abort.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/double.h"
+#include "ns3/log.h"
+#include "ns3/object-factory.h"
+#include "ns3/string.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+NS_LOG_COMPONENT_DEFINE("RemCacheLossModel");
+
+namespace ns3
+{
+
+NS_OBJECT_ENSURE_REGISTERED(RemCacheLossModel);
+
+namespace
+{
+
+const char REM_MAGIC[8] = {'L', 'T', 'E', 'R', 'E', 'M', '0', '1'};
+
+/// FNV-1a, only used to name tile files; the full key is stored and compared
+uint64_t
+HashKey(const std::string& key)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : key)
+    {
+        hash = (hash ^ c) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+/// Zero bytes after the key that keep the doubles and floats aligned
+uint32_t
+KeyPadding(uint32_t keyLength)
+{
+    return (8 - (sizeof(REM_MAGIC) + sizeof(uint32_t) + keyLength) % 8) % 8;
+}
+
+} // namespace
+
+TypeId
+RemCacheLossModel::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::RemCacheLossModel")
+            .SetParent<PropagationLossModel>()
+            .AddConstructor<RemCacheLossModel>()
+            .AddAttribute("Model",
+                          "Propagation loss model the map is computed from",
+                          TypeIdValue(FriisPropagationLossModel::GetTypeId()),
+                          MakeTypeIdAccessor(&RemCacheLossModel::m_modelTypeId),
+                          MakeTypeIdChecker())
+            .AddAttribute("Frequency",
+                          "Carrier frequency (Hz), passed on to the wrapped model",
+                          DoubleValue(2160e6),
+                          MakeDoubleAccessor(&RemCacheLossModel::SetFrequency,
+                                             &RemCacheLossModel::GetFrequency),
+                          MakeDoubleChecker<double>())
+            .AddAttribute("CacheDir",
+                          "Directory holding the tile files",
+                          StringValue("rem-cache"),
+                          MakeStringAccessor(&RemCacheLossModel::m_cacheDir),
+                          MakeStringChecker())
+            .AddAttribute("Bounds",
+                          "Area covered by the map; receivers outside use the wrapped model",
+                          RectangleValue(Rectangle(0.0, 200.0, 0.0, 200.0)),
+                          MakeRectangleAccessor(&RemCacheLossModel::m_bounds),
+                          MakeRectangleChecker())
+            .AddAttribute("Resolution",
+                          "Grid spacing of the map (m)",
+                          DoubleValue(5.0),
+                          MakeDoubleAccessor(&RemCacheLossModel::m_resolution),
+                          MakeDoubleChecker<double>(0.01))
+            .AddAttribute("RxHeight",
+                          "Receiver height the map is computed at (m)",
+                          DoubleValue(0.0),
+                          MakeDoubleAccessor(&RemCacheLossModel::m_rxHeight),
+                          MakeDoubleChecker<double>());
+    return tid;
+}
+
+RemCacheLossModel::RemCacheLossModel()
+    : m_frequency(2160e6),
+      m_resolution(5.0),
+      m_rxHeight(0.0),
+      m_loaded(0),
+      m_computed(0)
+{
+}
+
+RemCacheLossModel::~RemCacheLossModel()
+{
+    ReleaseTiles();
+}
+
+void
+RemCacheLossModel::DoDispose()
+{
+    NS_LOG_INFO("REM tiles loaded " << m_loaded << ", computed " << m_computed);
+    ReleaseTiles();
+    m_model = nullptr;
+    PropagationLossModel::DoDispose();
+}
+
+uint32_t
+RemCacheLossModel::GetLoadedTiles() const
+{
+    return m_loaded;
+}
+
+uint32_t
+RemCacheLossModel::GetComputedTiles() const
+{
+    return m_computed;
+}
+
+void
+RemCacheLossModel::ReleaseTiles()
+{
+    for (auto& entry : m_tiles)
+    {
+        if (entry.second.mapping)
+        {
+            munmap(const_cast<void*>(entry.second.mapping), entry.second.mappingSize);
+        }
+    }
+    m_tiles.clear();
+}
+
+Ptr<PropagationLossModel>
+RemCacheLossModel::GetModel() const
+{
+    if (!m_model)
+    {
+        ObjectFactory factory(m_modelTypeId.GetName());
+        m_model = factory.Create<PropagationLossModel>();
+        m_model->SetAttributeFailSafe("Frequency", DoubleValue(m_frequency));
+    }
+    return m_model;
+}
+
+void
+RemCacheLossModel::SetFrequency(double frequency)
+{
+    m_frequency = frequency;
+    if (m_model)
+    {
+        m_model->SetAttributeFailSafe("Frequency", DoubleValue(m_frequency));
+    }
+    // The frequency is part of the key
+    ReleaseTiles();
+}
+
+double
+RemCacheLossModel::GetFrequency() const
+{
+    return m_frequency;
+}
+
+std::string
+RemCacheLossModel::TileKey(const Vector& position) const
+{
+    std::ostringstream key;
+    key << std::setprecision(17) << "site=" << position.x << "," << position.y << ","
+        << position.z << ";bounds=" << m_bounds.xMin << "," << m_bounds.xMax << ","
+        << m_bounds.yMin << "," << m_bounds.yMax << ";resolution=" << m_resolution
+        << ";rxHeight=" << m_rxHeight << ";frequency=" << m_frequency
+        << ";model=" << m_modelTypeId.GetName();
+
+    // Attribute values of the model and its parents, except object pointers (random
+    // variables) whose serialized form is an address
+    Ptr<PropagationLossModel> model = GetModel();
+    for (TypeId tid = m_modelTypeId; tid != Object::GetTypeId(); tid = tid.GetParent())
+    {
+        for (uint32_t i = 0; i < tid.GetAttributeN(); ++i)
+        {
+            TypeId::AttributeInformation info = tid.GetAttribute(i);
+            if (!(info.flags & TypeId::ATTR_GET) ||
+                info.checker->GetValueTypeName() == "ns3::PointerValue")
+            {
+                continue;
+            }
+            StringValue value;
+            model->GetAttribute(info.name, value);
+            key << ";" << info.name << "=" << value.Get();
+        }
+    }
+    return key.str();
+}
+
+double
+RemCacheLossModel::DoCalcRxPower(double txPowerDbm,
+                                 Ptr<MobilityModel> a,
+                                 Ptr<MobilityModel> b) const
+{
+    bool aStatic = DynamicCast<ConstantPositionMobilityModel>(a) != nullptr;
+    bool bStatic = DynamicCast<ConstantPositionMobilityModel>(b) != nullptr;
+    if (aStatic != bStatic)
+    {
+        Ptr<MobilityModel> site = aStatic ? a : b;
+        Vector ue = (aStatic ? b : a)->GetPosition();
+        if (ue.x >= m_bounds.xMin && ue.x <= m_bounds.xMax && ue.y >= m_bounds.yMin &&
+            ue.y <= m_bounds.yMax)
+        {
+            return txPowerDbm - Lookup(GetTile(site), ue.x, ue.y);
+        }
+    }
+    return GetModel()->CalcRxPower(txPowerDbm, a, b);
+}
+
+int64_t
+RemCacheLossModel::DoAssignStreams(int64_t stream)
+{
+    return GetModel()->AssignStreams(stream);
+}
+
+const RemCacheLossModel::Tile&
+RemCacheLossModel::GetTile(Ptr<MobilityModel> site) const
+{
+    auto it = m_tiles.find(PeekPointer(site));
+    if (it != m_tiles.end())
+    {
+        return it->second;
+    }
+
+    Vector position = site->GetPosition();
+    std::string key = TileKey(position);
+    std::ostringstream fileName;
+    fileName << m_cacheDir << "/rem-" << std::hex << std::setw(16) << std::setfill('0')
+             << HashKey(key) << ".bin";
+
+    Tile& tile = m_tiles[PeekPointer(site)];
+    if (MapTile(fileName.str(), key, tile))
+    {
+        ++m_loaded;
+        return tile;
+    }
+    ComputeTile(position, key, fileName.str());
+    NS_ABORT_MSG_UNLESS(MapTile(fileName.str(), key, tile),
+                        "Cannot map REM tile " << fileName.str());
+    ++m_computed;
+    return tile;
+}
+
+void
+RemCacheLossModel::ComputeTile(const Vector& position,
+                               const std::string& key,
+                               const std::string& fileName) const
+{
+    uint32_t nx = std::ceil((m_bounds.xMax - m_bounds.xMin) / m_resolution) + 1;
+    uint32_t ny = std::ceil((m_bounds.yMax - m_bounds.yMin) / m_resolution) + 1;
+    NS_LOG_INFO("computing " << nx << "x" << ny << " REM tile for site " << position);
+
+    Ptr<ConstantPositionMobilityModel> tx = CreateObject<ConstantPositionMobilityModel>();
+    Ptr<ConstantPositionMobilityModel> rx = CreateObject<ConstantPositionMobilityModel>();
+    tx->SetPosition(position);
+    std::vector<float> loss(static_cast<size_t>(nx) * ny);
+    for (uint32_t iy = 0; iy < ny; ++iy)
+    {
+        for (uint32_t ix = 0; ix < nx; ++ix)
+        {
+            rx->SetPosition(Vector(m_bounds.xMin + ix * m_resolution,
+                                   m_bounds.yMin + iy * m_resolution,
+                                   m_rxHeight));
+            loss[static_cast<size_t>(iy) * nx + ix] = -GetModel()->CalcRxPower(0.0, tx, rx);
+        }
+    }
+
+    // Written under a private name and renamed, so concurrent sweep runs computing the
+    // same tile never map a partial file
+    mkdir(m_cacheDir.c_str(), 0755);
+    std::string tmpName = fileName + ".tmp" + std::to_string(getpid());
+    std::ofstream out(tmpName, std::ios::binary);
+    NS_ABORT_MSG_UNLESS(out.is_open(), "Cannot write REM tile " << tmpName);
+    uint32_t keyLength = key.size();
+    double origin[3] = {m_bounds.xMin, m_bounds.yMin, m_resolution};
+    uint32_t size[2] = {nx, ny};
+    out.write(REM_MAGIC, sizeof(REM_MAGIC));
+    out.write(reinterpret_cast<const char*>(&keyLength), sizeof(keyLength));
+    out.write(key.data(), key.size());
+    const char padding[8] = {};
+    out.write(padding, KeyPadding(keyLength));
+    out.write(reinterpret_cast<const char*>(origin), sizeof(origin));
+    out.write(reinterpret_cast<const char*>(size), sizeof(size));
+    out.write(reinterpret_cast<const char*>(loss.data()), loss.size() * sizeof(float));
+    out.close();
+    NS_ABORT_MSG_IF(!out || std::rename(tmpName.c_str(), fileName.c_str()) != 0,
+                    "Cannot store REM tile " << fileName << ": " << strerror(errno));
+}
+
+bool
+RemCacheLossModel::MapTile(const std::string& fileName, const std::string& key, Tile& tile) const
+{
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(REM_MAGIC) + 4))
+    {
+        close(fd);
+        return false;
+    }
+    void* mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        return false;
+    }
+
+    // Every length read from the file is checked against the bytes left after it before
+    // a pointer is formed from it: a truncated or corrupt file must not point past the end
+    const char* p = static_cast<const char*>(mapping);
+    size_t left = st.st_size - sizeof(REM_MAGIC);
+    uint32_t keyLength;
+    std::memcpy(&keyLength, p + sizeof(REM_MAGIC), sizeof(keyLength));
+    left -= sizeof(keyLength);
+    size_t keyBytes = static_cast<size_t>(keyLength) + KeyPadding(keyLength);
+    const size_t headerBytes = 3 * sizeof(double) + 2 * sizeof(uint32_t);
+    bool valid = std::memcmp(p, REM_MAGIC, sizeof(REM_MAGIC)) == 0 &&
+                 keyLength == key.size() && keyBytes <= left && headerBytes <= left - keyBytes;
+    if (valid)
+    {
+        const char* storedKey = p + sizeof(REM_MAGIC) + sizeof(keyLength);
+        valid = std::memcmp(storedKey, key.data(), keyLength) == 0;
+        left -= keyBytes + headerBytes;
+        const char* header = storedKey + keyBytes;
+        double origin[3];
+        uint32_t size[2];
+        std::memcpy(origin, header, sizeof(origin));
+        std::memcpy(size, header + sizeof(origin), sizeof(size));
+        const char* data = header + headerBytes;
+        valid = valid && size[0] >= 2 && size[1] >= 2 && left % sizeof(float) == 0 &&
+                static_cast<uint64_t>(size[0]) * size[1] == left / sizeof(float);
+        if (valid)
+        {
+            tile.mapping = mapping;
+            tile.mappingSize = st.st_size;
+            tile.loss = reinterpret_cast<const float*>(data);
+            tile.x0 = origin[0];
+            tile.y0 = origin[1];
+            tile.resolution = origin[2];
+            tile.nx = size[0];
+            tile.ny = size[1];
+            return true;
+        }
+    }
+    // Hash collision or stale/partial file: recompute over it
+    munmap(mapping, st.st_size);
+    return false;
+}
+
+double
+RemCacheLossModel::Lookup(const Tile& tile, double x, double y)
+{
+    double fx = (x - tile.x0) / tile.resolution;
+    double fy = (y - tile.y0) / tile.resolution;
+    uint32_t ix = std::min<uint32_t>(std::max(fx, 0.0), tile.nx - 2);
+    uint32_t iy = std::min<uint32_t>(std::max(fy, 0.0), tile.ny - 2);
+    double tx = std::clamp(fx - ix, 0.0, 1.0);
+    double ty = std::clamp(fy - iy, 0.0, 1.0);
+    const float* row = tile.loss + static_cast<size_t>(iy) * tile.nx + ix;
+    double bottom = row[0] + (row[1] - row[0]) * tx;
+    double top = row[tile.nx] + (row[tile.nx + 1] - row[tile.nx]) * tx;
+    return bottom + (top - bottom) * ty;
+}
+
+} // namespace ns3
@@ -0,0 +1,100 @@
+/* rem-cache-loss-model.h
+ *
+ * Precomputed radio environment map for static sites (--remCache=<dir>).
+ *
+ * The eNBs never move, so the loss field around each of them is the same in every run
+ * of a layout. The first time a site is seen, the wrapped propagation model is evaluated
+ * once per point of a Resolution-spaced grid over Bounds (receiver at RxHeight) and the
+ * tile is written to CacheDir under a hash of its key: site position, grid, frequency,
+ * and the wrapped model's TypeId and attribute values. Later lookups, and every later
+ * process of a sweep, memory map the tile read-only (the page cache shares it between
+ * concurrent runs) and answer CalcRxPower with a bilinear interpolation instead of
+ * evaluating the model.
+ *
+ * A pair is served from the map when exactly one end is a ConstantPositionMobilityModel
+ * (the site) and the other lies inside Bounds; uplink pairs reuse the downlink tile,
+ * which assumes a reciprocal model. Anything else is passed to the wrapped model. Only
+ * path loss is tabulated: SINR depends on scheduling and stays computed per TTI.
+ *
+ * Tile file: the 8-byte magic "LTEREM01", uint32 key length, the key zero-padded to an
+ * 8-byte boundary, then double x0, y0, resolution, uint32 nx, ny and nx * ny float losses
+ * in dB, row-major in y, all in host byte order.
+ */
+
+#ifndef REM_CACHE_LOSS_MODEL_H
+#define REM_CACHE_LOSS_MODEL_H
+
+#include "ns3/propagation-loss-model.h"
+#include "ns3/rectangle.h"
+#include "ns3/type-id.h"
+#include "ns3/vector.h"
+
+#include <string>
+#include <unordered_map>
+
+namespace ns3
+{
+
+class RemCacheLossModel : public PropagationLossModel
+{
+  public:
+    static TypeId GetTypeId();
+
+    RemCacheLossModel();
+    ~RemCacheLossModel() override;
+
+    /// Tiles loaded from CacheDir and tiles computed by this process so far
+    uint32_t GetLoadedTiles() const;
+    uint32_t GetComputedTiles() const;
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    /// A mapped tile
+    struct Tile
+    {
+        const void* mapping = nullptr;
+        size_t mappingSize = 0;
+        const float* loss = nullptr;
+        double x0 = 0;
+        double y0 = 0;
+        double resolution = 1;
+        uint32_t nx = 0;
+        uint32_t ny = 0;
+    };
+
+    double DoCalcRxPower(double txPowerDbm,
+                         Ptr<MobilityModel> a,
+                         Ptr<MobilityModel> b) const override;
+    int64_t DoAssignStreams(int64_t stream) override;
+
+    Ptr<PropagationLossModel> GetModel() const;
+    void SetFrequency(double frequency);
+    double GetFrequency() const;
+
+    /// Tile of \p site, loading or computing it on first use
+    const Tile& GetTile(Ptr<MobilityModel> site) const;
+    std::string TileKey(const Vector& position) const;
+    void ComputeTile(const Vector& position,
+                     const std::string& key,
+                     const std::string& fileName) const;
+    bool MapTile(const std::string& fileName, const std::string& key, Tile& tile) const;
+    static double Lookup(const Tile& tile, double x, double y);
+    void ReleaseTiles();
+
+    TypeId m_modelTypeId;
+    double m_frequency;
+    std::string m_cacheDir;
+    Rectangle m_bounds;
+    double m_resolution;
+    double m_rxHeight;
+    mutable Ptr<PropagationLossModel> m_model;
+    mutable std::unordered_map<const MobilityModel*, Tile> m_tiles;
+    mutable uint32_t m_loaded;
+    mutable uint32_t m_computed;
+};
+
+} // namespace ns3
+
+#endif /* REM_CACHE_LOSS_MODEL_H */
@@ -0,0 +1,172 @@
+/* saturated-source.cc
+ *
+ * See saturated-source.h
+ */
+
+#include "saturated-source.h"
+
+#include "ns3/abort.h"
+#include "ns3/eps-bearer-tag.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/log.h"
+#include "ns3/lte-enb-rrc.h"
+#include "ns3/lte-ue-rrc.h"
+#include "ns3/simulator.h"
+#include "ns3/udp-header.h"
+#include "ns3/udp-l4-protocol.h"
+#include "ns3/uinteger.h"
+
+NS_LOG_COMPONENT_DEFINE("SaturatedSource");
+
+namespace ns3
+{
+
+NS_OBJECT_ENSURE_REGISTERED(SaturatedSource);
+
+namespace
+{
+/// EPS bearer id of the default bearer set up at attach
+const uint8_t DEFAULT_BEARER_ID = 1;
+/// IPv4 + UDP header bytes added to every payload
+const uint32_t HEADER_BYTES = 20 + 8;
+} // namespace
+
+TypeId
+SaturatedSource::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::SaturatedSource")
+            .SetParent<Application>()
+            .AddConstructor<SaturatedSource>()
+            .AddAttribute("Rate",
+                          "Offered rate; keep it above the cell capacity to saturate the UE",
+                          DataRateValue(DataRate("100Mb/s")),
+                          MakeDataRateAccessor(&SaturatedSource::m_rate),
+                          MakeDataRateChecker())
+            .AddAttribute("PacketSize",
+                          "IP packet size in bytes, headers included",
+                          UintegerValue(1400),
+                          MakeUintegerAccessor(&SaturatedSource::m_packetSize),
+                          MakeUintegerChecker<uint32_t>(HEADER_BYTES + 1))
+            .AddAttribute("Interval",
+                          "Time between two packet trains; one TTI by default",
+                          TimeValue(MilliSeconds(1)),
+                          MakeTimeAccessor(&SaturatedSource::m_interval),
+                          MakeTimeChecker())
+            .AddAttribute("Port",
+                          "Destination UDP port on the UE",
+                          UintegerValue(9000),
+                          MakeUintegerAccessor(&SaturatedSource::m_port),
+                          MakeUintegerChecker<uint16_t>())
+            .AddAttribute("SourceAddress",
+                          "Source address written in the IPv4 header",
+                          Ipv4AddressValue("1.0.0.2"),
+                          MakeIpv4AddressAccessor(&SaturatedSource::m_sourceAddress),
+                          MakeIpv4AddressChecker());
+    return tid;
+}
+
+SaturatedSource::SaturatedSource()
+    : m_credit(0),
+      m_totalTx(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+SaturatedSource::~SaturatedSource()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+SaturatedSource::Setup(Ptr<LteUeNetDevice> ueDevice,
+                       Ipv4Address ueAddress,
+                       const NetDeviceContainer& enbDevices)
+{
+    m_ueDevice = ueDevice;
+    m_ueAddress = ueAddress;
+    m_enbByCellId.clear();
+    for (auto it = enbDevices.Begin(); it != enbDevices.End(); ++it)
+    {
+        Ptr<LteEnbNetDevice> enb = DynamicCast<LteEnbNetDevice>(*it);
+        NS_ASSERT_MSG(enb, "Not an LteEnbNetDevice");
+        m_enbByCellId[enb->GetCellId()] = enb;
+    }
+}
+
+uint64_t
+SaturatedSource::GetTotalTx() const
+{
+    return m_totalTx;
+}
+
+void
+SaturatedSource::DoDispose()
+{
+    m_ueDevice = nullptr;
+    m_enbByCellId.clear();
+    Application::DoDispose();
+}
+
+void
+SaturatedSource::StartApplication()
+{
+    NS_LOG_FUNCTION(this);
+    NS_ABORT_MSG_UNLESS(m_ueDevice, "SaturatedSource::Setup() was not called");
+    m_credit = 0;
+    m_sendEvent = Simulator::ScheduleNow(&SaturatedSource::SendTrain, this);
+}
+
+void
+SaturatedSource::StopApplication()
+{
+    NS_LOG_FUNCTION(this);
+    Simulator::Cancel(m_sendEvent);
+}
+
+void
+SaturatedSource::SendTrain()
+{
+    m_sendEvent = Simulator::Schedule(m_interval, &SaturatedSource::SendTrain, this);
+
+    Ptr<LteUeRrc> ueRrc = m_ueDevice->GetRrc();
+    if (ueRrc->GetState() != LteUeRrc::CONNECTED_NORMALLY)
+    {
+        // Not attached yet or in handover: nothing is buffered meanwhile, like a
+        // backlogged source that is simply not being served
+        m_credit = 0;
+        return;
+    }
+    auto enb = m_enbByCellId.find(ueRrc->GetCellId());
+    NS_ASSERT_MSG(enb != m_enbByCellId.end(), "UE served by unknown cell " << ueRrc->GetCellId());
+    Ptr<LteEnbRrc> enbRrc = enb->second->GetRrc();
+    uint16_t rnti = ueRrc->GetRnti();
+
+    m_credit += m_rate.GetBitRate() * m_interval.GetSeconds() / 8.0;
+    while (m_credit >= m_packetSize)
+    {
+        Ptr<Packet> packet = Create<Packet>(m_packetSize - HEADER_BYTES);
+
+        UdpHeader udp;
+        udp.SetSourcePort(49153);
+        udp.SetDestinationPort(m_port);
+        packet->AddHeader(udp);
+
+        Ipv4Header ip;
+        ip.SetSource(m_sourceAddress);
+        ip.SetDestination(m_ueAddress);
+        ip.SetProtocol(UdpL4Protocol::PROT_NUMBER);
+        ip.SetPayloadSize(packet->GetSize());
+        ip.SetTtl(64);
+        packet->AddHeader(ip);
+
+        packet->AddPacketTag(EpsBearerTag(rnti, DEFAULT_BEARER_ID));
+        enbRrc->SendData(packet);
+
+        m_credit -= m_packetSize;
+        m_totalTx += m_packetSize;
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,76 @@
+/* saturated-source.h
+ *
+ * Full-buffer downlink source for radio/scheduler studies (--bulkModel=saturated).
+ *
+ * Instead of driving a TCP connection from a remote host through the PGW, the S1-U
+ * tunnel and the eNB's EPC application, the source builds IPv4/UDP packets addressed to
+ * the UE and hands them straight to the serving eNB's RRC on the UE's default bearer,
+ * every Interval, at Rate. Keep Rate above what the cell can serve and the eNB RLC
+ * transmission buffer of the UE stays full, the RLC dropping whatever does not fit;
+ * the UE receives ordinary UDP packets that a PacketSink can count.
+ */
+
+#ifndef SATURATED_SOURCE_H
+#define SATURATED_SOURCE_H
+
+#include "ns3/application.h"
+#include "ns3/data-rate.h"
+#include "ns3/event-id.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/lte-enb-net-device.h"
+#include "ns3/lte-ue-net-device.h"
+#include "ns3/net-device-container.h"
+
+#include <map>
+
+namespace ns3
+{
+
+class SaturatedSource : public Application
+{
+  public:
+    static TypeId GetTypeId();
+
+    SaturatedSource();
+    ~SaturatedSource() override;
+
+    /**
+     * \param ueDevice the UE to keep saturated
+     * \param ueAddress IPv4 address of the UE (destination of the packets)
+     * \param enbDevices every eNB the UE may be served by
+     */
+    void Setup(Ptr<LteUeNetDevice> ueDevice,
+               Ipv4Address ueAddress,
+               const NetDeviceContainer& enbDevices);
+
+    /// Bytes handed to the eNB so far (including IP/UDP headers)
+    uint64_t GetTotalTx() const;
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    void StartApplication() override;
+    void StopApplication() override;
+
+    /// Inject this interval's worth of packets and reschedule
+    void SendTrain();
+
+    Ptr<LteUeNetDevice> m_ueDevice;
+    Ipv4Address m_ueAddress;
+    std::map<uint16_t, Ptr<LteEnbNetDevice>> m_enbByCellId;
+
+    DataRate m_rate;
+    uint32_t m_packetSize;
+    Time m_interval;
+    uint16_t m_port;
+    Ipv4Address m_sourceAddress;
+
+    double m_credit; ///< bytes allowed but not yet sent
+    uint64_t m_totalTx;
+    EventId m_sendEvent;
+};
+
+} // namespace ns3
+
+#endif /* SATURATED_SOURCE_H */
@@ -0,0 +1,194 @@
+/* scenario-profiler.cc
+ *
+ * See scenario-profiler.h
+ */
+
+#include "scenario-profiler.h"
+
+#include "instrumented-scheduler.h"
+
+#include "ns3/simulator.h"
+
+#include <fstream>
+#include <iomanip>
+#include <sys/resource.h>
+#include <unistd.h>
+
+namespace ns3
+{
+
+ScenarioProfiler::ScenarioProfiler(bool enabled)
+    : m_enabled(enabled),
+      m_phaseStartEvents(0),
+      m_created(Clock::now()),
+      m_lastSampleEvents(0)
+{
+}
+
+ScenarioProfiler::~ScenarioProfiler()
+{
+    Simulator::Cancel(m_sampleEvent);
+}
+
+bool
+ScenarioProfiler::IsEnabled() const
+{
+    return m_enabled;
+}
+
+void
+ScenarioProfiler::StartPhase(const std::string& name)
+{
+    if (!m_enabled)
+    {
+        return;
+    }
+    Stop();
+    m_current = name;
+    m_phaseStart = Clock::now();
+    m_phaseStartEvents = Simulator::GetEventCount();
+}
+
+void
+ScenarioProfiler::Stop()
+{
+    if (!m_enabled || m_current.empty())
+    {
+        return;
+    }
+    std::chrono::duration<double> wall = Clock::now() - m_phaseStart;
+    m_phases.push_back({m_current,
+                        wall.count(),
+                        Simulator::GetEventCount() - m_phaseStartEvents,
+                        GetCurrentRssKb()});
+    m_current.clear();
+}
+
+void
+ScenarioProfiler::SetEventQueue(const std::string& name)
+{
+    m_eventQueue = name;
+}
+
+void
+ScenarioProfiler::StartEventSampling(Time interval)
+{
+    if (!m_enabled || interval <= Seconds(0))
+    {
+        return;
+    }
+    m_sampleInterval = interval;
+    m_lastSampleWall = Clock::now();
+    m_lastSampleEvents = Simulator::GetEventCount();
+    m_sampleEvent = Simulator::Schedule(m_sampleInterval, &ScenarioProfiler::SampleEvents, this);
+}
+
+void
+ScenarioProfiler::SampleEvents()
+{
+    Clock::time_point now = Clock::now();
+    uint64_t events = Simulator::GetEventCount();
+    std::chrono::duration<double> wall = now - m_lastSampleWall;
+    uint64_t queued = m_eventQueue.empty() ? 0 : InstrumentedScheduler::GetStats().size;
+    m_samples.push_back(
+        {Simulator::Now().GetSeconds(), wall.count(), events - m_lastSampleEvents, queued});
+    m_lastSampleWall = now;
+    m_lastSampleEvents = events;
+    m_sampleEvent = Simulator::Schedule(m_sampleInterval, &ScenarioProfiler::SampleEvents, this);
+}
+
+void
+ScenarioProfiler::Report(std::ostream& os) const
+{
+    if (!m_enabled)
+    {
+        return;
+    }
+    std::chrono::duration<double> total = Clock::now() - m_created;
+    uint64_t totalEvents = Simulator::GetEventCount();
+
+    os << "==== profile ====\n";
+    os << std::left << std::setw(24) << "phase" << std::right << std::setw(12) << "wall_s"
+       << std::setw(8) << "share" << std::setw(14) << "events" << std::setw(14) << "events/s"
+       << std::setw(12) << "rss_kb" << "\n";
+    for (const Phase& p : m_phases)
+    {
+        os << std::left << std::setw(24) << p.name << std::right << std::fixed
+           << std::setprecision(3) << std::setw(12) << p.wallSeconds << std::setprecision(1)
+           << std::setw(7) << (total.count() > 0 ? 100.0 * p.wallSeconds / total.count() : 0.0)
+           << "%" << std::setw(14) << p.events << std::setprecision(0) << std::setw(14)
+           << (p.wallSeconds > 0 ? p.events / p.wallSeconds : 0.0) << std::setw(12) << p.rssKbEnd
+           << "\n";
+    }
+    os << std::setprecision(3) << "total wall time: " << total.count() << " s\n";
+    os << "scheduler events: " << totalEvents << " ("
+       << std::setprecision(0) << (total.count() > 0 ? totalEvents / total.count() : 0.0)
+       << " events/s overall)\n";
+    os << "peak RSS: " << GetPeakRssKb() << " KiB\n";
+    if (!m_eventQueue.empty())
+    {
+        const InstrumentedScheduler::Stats& q = InstrumentedScheduler::GetStats();
+        double queueSeconds = q.queueNs * 1e-9;
+        double share = total.count() > 0 ? 100.0 * queueSeconds / total.count() : 0.0;
+        os << "event queue (" << m_eventQueue << "): " << q.inserts << " inserts, "
+           << q.removeNexts << " dequeued, " << q.removes << " removed, peak length "
+           << q.peakSize << ", mean length at dequeue " << std::setprecision(0)
+           << (q.removeNexts > 0 ? q.sizeSum / q.removeNexts : 0.0) << "\n";
+        os << std::setprecision(3) << "event queue time: " << queueSeconds << " s ("
+           << std::setprecision(1) << share
+           << "% of wall time, " << std::setprecision(0)
+           << (q.inserts > 0 ? 1e9 * queueSeconds / q.inserts : 0.0) << " ns per event)\n";
+    }
+
+    if (!m_samples.empty())
+    {
+        os << "---- events/s during Run() ----\n";
+        os << std::setw(10) << "sim_s" << std::setw(14) << "events" << std::setw(14)
+           << "events/s" << std::setw(12) << "sim/wall";
+        if (!m_eventQueue.empty())
+        {
+            os << std::setw(12) << "queued";
+        }
+        os << "\n";
+        for (const Sample& s : m_samples)
+        {
+            os << std::setprecision(3) << std::setw(10) << s.simSeconds << std::setw(14)
+               << s.events << std::setprecision(0) << std::setw(14)
+               << (s.wallSeconds > 0 ? s.events / s.wallSeconds : 0.0) << std::setprecision(3)
+               << std::setw(12)
+               << (s.wallSeconds > 0 ? m_sampleInterval.GetSeconds() / s.wallSeconds : 0.0);
+            if (!m_eventQueue.empty())
+            {
+                os << std::setw(12) << s.queued;
+            }
+            os << "\n";
+        }
+    }
+    os << std::defaultfloat;
+}
+
+uint64_t
+ScenarioProfiler::GetPeakRssKb()
+{
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+        return 0;
+    }
+    return static_cast<uint64_t>(usage.ru_maxrss); // KiB on Linux
+}
+
+uint64_t
+ScenarioProfiler::GetCurrentRssKb()
+{
+    std::ifstream statm("/proc/self/statm");
+    uint64_t size = 0;
+    uint64_t resident = 0;
+    if (!(statm >> size >> resident))
+    {
+        return 0;
+    }
+    return resident * static_cast<uint64_t>(sysconf(_SC_PAGESIZE)) / 1024;
+}
+
+} // namespace ns3
@@ -0,0 +1,93 @@
+/* scenario-profiler.h
+ *
+ * Wall-clock / event-rate profiler for the phases of the LTE scenario (--profile).
+ *
+ * Phases are consecutive: StartPhase() closes the running phase and opens the next one,
+ * Stop() closes the last. While Simulator::Run() executes, a periodic event samples the
+ * scheduler event counter so the events/s rate can be plotted against simulated time.
+ * Once SetEventQueue() names the backend behind an InstrumentedScheduler, the samples
+ * also carry the event queue length and the report adds the queue statistics.
+ * A disabled profiler turns every call into a no-op.
+ */
+
+#ifndef SCENARIO_PROFILER_H
+#define SCENARIO_PROFILER_H
+
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+class ScenarioProfiler
+{
+  public:
+    explicit ScenarioProfiler(bool enabled);
+    ~ScenarioProfiler();
+
+    bool IsEnabled() const;
+
+    /// Close the running phase (if any) and start timing \p name
+    void StartPhase(const std::string& name);
+    /// Close the running phase
+    void Stop();
+
+    /// Report the InstrumentedScheduler statistics of the \p name backend
+    void SetEventQueue(const std::string& name);
+
+    /// Sample the executed event count every \p interval of simulated time
+    void StartEventSampling(Time interval);
+
+    /// Print the per-phase table, the event totals and the events/s samples
+    void Report(std::ostream& os) const;
+
+    /// Peak resident set size of this process in KiB
+    static uint64_t GetPeakRssKb();
+    /// Current resident set size of this process in KiB (0 if unavailable)
+    static uint64_t GetCurrentRssKb();
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Phase
+    {
+        std::string name;
+        double wallSeconds;
+        uint64_t events;    ///< scheduler events executed during the phase
+        uint64_t rssKbEnd;  ///< resident set size when the phase ended
+    };
+
+    struct Sample
+    {
+        double simSeconds;
+        double wallSeconds; ///< since the previous sample
+        uint64_t events;    ///< since the previous sample
+        uint64_t queued;    ///< event queue length (0 without SetEventQueue())
+    };
+
+    void SampleEvents();
+
+    bool m_enabled;
+    std::vector<Phase> m_phases;
+    std::string m_current;
+    Clock::time_point m_phaseStart;
+    uint64_t m_phaseStartEvents;
+    Clock::time_point m_created;
+    std::string m_eventQueue; ///< instrumented backend, empty if none
+
+    Time m_sampleInterval;
+    EventId m_sampleEvent;
+    Clock::time_point m_lastSampleWall;
+    uint64_t m_lastSampleEvents;
+    std::vector<Sample> m_samples;
+};
+
+} // namespace ns3
+
+#endif /* SCENARIO_PROFILER_H */
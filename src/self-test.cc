@@ -0,0 +1,457 @@
+/* self-test.cc
+ *
+ * See self-test.h
+ */
+
+#include "self-test.h"
+
+#include "log-bucket-sketch.h"
+#include "trajectory-streamer.h"
+#include "trie-ipv4-routing.h"
+#include "tti-bucket-scheduler.h"
+
+#include "ns3/abort.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-route.h"
+#include "ns3/mac48-address.h"
+#include "ns3/map-scheduler.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <unistd.h>
+#include <vector>
+
+namespace ns3
+{
+
+namespace
+{
+
+/// Counts the expectations of one check and keeps the failed ones
+class Checker
+{
+  public:
+    void Expect(bool ok, const std::string& what)
+    {
+        ++m_expectations;
+        if (!ok)
+        {
+            m_failures.push_back(what);
+        }
+    }
+
+    uint32_t GetExpectations() const
+    {
+        return m_expectations;
+    }
+
+    const std::vector<std::string>& GetFailures() const
+    {
+        return m_failures;
+    }
+
+  private:
+    uint32_t m_expectations = 0;
+    std::vector<std::string> m_failures;
+};
+
+/// A file under /tmp holding \p content, removed again on destruction
+class TempFile
+{
+  public:
+    explicit TempFile(const std::string& content)
+    {
+        char name[] = "/tmp/lte-selftest-XXXXXX";
+        int fd = mkstemp(name);
+        NS_ABORT_MSG_IF(fd < 0, "Cannot create a temporary file");
+        close(fd);
+        m_name = name;
+        std::ofstream(m_name) << content;
+    }
+
+    ~TempFile()
+    {
+        unlink(m_name.c_str());
+    }
+
+    const std::string& GetName() const
+    {
+        return m_name;
+    }
+
+  private:
+    std::string m_name;
+};
+
+struct WaypointLog
+{
+    void Add(uint32_t ue, const Waypoint& waypoint)
+    {
+        waypoints[ue].push_back(waypoint);
+    }
+
+    std::map<uint32_t, std::vector<Waypoint>> waypoints;
+};
+
+/// Moves that take no time must not give WaypointMobilityModel two equal times
+void
+CheckTrajectoryNs2(Checker& c)
+{
+    TempFile trace("$node_(0) set X_ 10.0\n"
+                   "$node_(0) set Y_ 20.0\n"
+                   "$ns_ at 0.0 \"$node_(0) setdest 10.0 20.0 5.0\"\n"  // to where it is
+                   "$ns_ at 1.0 \"$node_(0) setdest 30.0 20.0 0.0\"\n"  // parked
+                   "$ns_ at 2.0 \"$node_(0) setdest 40.0 20.0 10.0\"\n" // 3 s
+                   "$ns_ at 5.0 \"$node_(0) setdest 40.0 20.0 10.0\"\n" // there already
+                   "$node_(1) set X_ 0.0\n"
+                   "$node_(1) set Y_ 0.0\n"
+                   "$ns_ at 0.0 \"$node_(1) setdest 0.0 0.0 0.0\"\n"); // parked for good
+    WaypointLog log;
+    {
+        TrajectoryStreamer streamer(trace.GetName(),
+                                    TrajectoryStreamer::NS2,
+                                    2,
+                                    MakeCallback(&WaypointLog::Add, &log),
+                                    Seconds(100));
+        streamer.Start();
+    }
+
+    for (const auto& ue : log.waypoints)
+    {
+        for (size_t i = 1; i < ue.second.size(); ++i)
+        {
+            std::ostringstream what;
+            what << "UE " << ue.first << " waypoint " << i << " at "
+                 << ue.second[i].time.As(Time::S) << " is not after the previous one";
+            c.Expect(ue.second[i].time > ue.second[i - 1].time, what.str());
+        }
+    }
+    const std::vector<Waypoint>& moving = log.waypoints[0];
+    c.Expect(moving.size() == 3, "UE 0 should get its start, the 2 s hold and the arrival");
+    if (moving.size() == 3)
+    {
+        c.Expect(moving[0].time == Seconds(0) && moving[0].position.x == 10.0,
+                 "UE 0 should start at x = 10 at 0 s");
+        c.Expect(moving[1].time == Seconds(2) && moving[1].position.x == 10.0,
+                 "UE 0 should hold x = 10 until 2 s");
+        c.Expect(moving[2].time == Seconds(5) && moving[2].position.x == 40.0,
+                 "UE 0 should reach x = 40 at 5 s");
+    }
+    c.Expect(log.waypoints[1].size() == 1, "the parked UE 1 should only get its position");
+}
+
+/// Same (timestamp, uid) order as MapScheduler under random Insert / Remove / RemoveNext
+void
+CheckTtiBucketScheduler(Checker& c)
+{
+    // Few buckets keep most events in the overflow heap and make the window jump often;
+    // a 1 us width puts most of them in ticks already passed
+    const std::pair<uint32_t, Time> configs[] = {{2, MilliSeconds(1)},
+                                                 {8, MilliSeconds(1)},
+                                                 {1024, MilliSeconds(1)},
+                                                 {16, MicroSeconds(1)}};
+    for (const auto& config : configs)
+    {
+        Ptr<Scheduler> tti = CreateObjectWithAttributes<TtiBucketScheduler>(
+            "Buckets", UintegerValue(config.first),
+            "BucketWidth", TimeValue(config.second));
+        Ptr<Scheduler> reference = CreateObject<MapScheduler>();
+        std::ostringstream label;
+        label << config.first << " buckets of " << config.second.As(Time::US) << ": ";
+
+        std::mt19937_64 random(config.first);
+        std::map<uint32_t, Scheduler::Event> pending; // by uid
+        uint64_t now = 0;
+        uint32_t uid = 0;
+        bool same = true;
+        for (uint32_t op = 0; op < 200000 && same; ++op)
+        {
+            uint32_t kind = random() % 10;
+            if (kind < 5 || reference->IsEmpty())
+            {
+                // Same tick, next TTIs, timers beyond the window, or exactly on a tick
+                uint64_t delay;
+                switch (random() % 4)
+                {
+                case 0:
+                    delay = random() % 1000;
+                    break;
+                case 1:
+                    delay = random() % 3000000;
+                    break;
+                case 2:
+                    delay = random() % 2000000000;
+                    break;
+                default:
+                    delay = (random() % 3) * 1000000;
+                }
+                Scheduler::Event ev;
+                ev.impl = nullptr;
+                ev.key.m_ts = now + delay;
+                ev.key.m_uid = uid++;
+                ev.key.m_context = 0;
+                tti->Insert(ev);
+                reference->Insert(ev);
+                pending[ev.key.m_uid] = ev;
+            }
+            else if (kind < 9)
+            {
+                Scheduler::Event a = tti->RemoveNext();
+                Scheduler::Event b = reference->RemoveNext();
+                same = a.key.m_ts == b.key.m_ts && a.key.m_uid == b.key.m_uid;
+                now = b.key.m_ts;
+                pending.erase(b.key.m_uid);
+            }
+            else
+            {
+                // A cancelled event anywhere in the queue: current tick, window or overflow
+                auto it = pending.lower_bound(random() % uid);
+                if (it == pending.end())
+                {
+                    it = pending.begin();
+                }
+                tti->Remove(it->second);
+                reference->Remove(it->second);
+                pending.erase(it);
+            }
+            same = same && tti->IsEmpty() == reference->IsEmpty();
+            if (same && !reference->IsEmpty())
+            {
+                Scheduler::Event a = tti->PeekNext();
+                Scheduler::Event b = reference->PeekNext();
+                same = a.key.m_ts == b.key.m_ts && a.key.m_uid == b.key.m_uid;
+            }
+            if (!same)
+            {
+                std::ostringstream what;
+                what << label.str() << "order differs from MapScheduler at operation " << op;
+                c.Expect(false, what.str());
+            }
+        }
+        if (same)
+        {
+            c.Expect(true, label.str());
+        }
+    }
+}
+
+/// RouteOutput of \p routing to \p destination, nullptr if there is no route
+Ptr<Ipv4Route>
+RouteTo(Ptr<TrieIpv4Routing> routing, const char* destination, Ptr<NetDevice> oif = nullptr)
+{
+    Ipv4Header header;
+    header.SetDestination(Ipv4Address(destination));
+    Socket::SocketErrno sockerr;
+    return routing->RouteOutput(Create<Packet>(), header, oif, sockerr);
+}
+
+bool
+Through(Ptr<Ipv4Route> route, Ptr<NetDevice> device, const char* gateway)
+{
+    return route && route->GetOutputDevice() == device &&
+           route->GetGateway() == Ipv4Address(gateway);
+}
+
+/// Longest prefix, then lowest metric, among the routes up and through the requested device
+void
+CheckTrieRouting(Checker& c)
+{
+    // Like the UEs: the default route comes with the stack, before interface 1 exists
+    Ptr<Node> node = CreateObject<Node>();
+    TrieIpv4RoutingHelper trie;
+    trie.SetDefaultRoute(Ipv4Address("10.1.1.254"), 1);
+    InternetStackHelper internet;
+    internet.SetRoutingHelper(trie);
+    internet.Install(node);
+    Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
+    Ptr<TrieIpv4Routing> routing = DynamicCast<TrieIpv4Routing>(ipv4->GetRoutingProtocol());
+    NS_ABORT_MSG_UNLESS(routing, "InternetStackHelper did not install TrieIpv4Routing");
+    c.Expect(!RouteTo(routing, "8.8.8.8"), "the preset default route has no interface yet");
+
+    Ptr<SimpleChannel> channel = CreateObject<SimpleChannel>();
+    Ptr<NetDevice> devices[3];
+    const char* addresses[3] = {nullptr, "10.1.1.1", "10.2.2.1"};
+    for (uint32_t i = 1; i < 3; ++i)
+    {
+        Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice>();
+        device->SetAddress(Mac48Address::Allocate());
+        device->SetChannel(channel);
+        node->AddDevice(device);
+        uint32_t interface = ipv4->AddInterface(device);
+        NS_ABORT_MSG_UNLESS(interface == i, "Unexpected interface index " << interface);
+        ipv4->AddAddress(i, Ipv4InterfaceAddress(Ipv4Address(addresses[i]), "255.255.255.0"));
+        ipv4->SetUp(i);
+        devices[i] = device;
+    }
+    c.Expect(Through(RouteTo(routing, "8.8.8.8"), devices[1], "10.1.1.254"),
+             "the preset default route should apply once interface 1 is up");
+    c.Expect(Through(RouteTo(routing, "10.2.2.7"), devices[2], "0.0.0.0"),
+             "10.2.2.7 should be on link through interface 2");
+
+    routing->AddNetworkRouteTo("7.0.0.0", "255.0.0.0", "10.2.2.254", 2);
+    routing->AddNetworkRouteTo("7.1.2.0", "255.255.255.0", "10.1.1.253", 1);
+    c.Expect(Through(RouteTo(routing, "7.1.2.3"), devices[1], "10.1.1.253"),
+             "7.1.2.3 should take the /24 over the /8");
+    c.Expect(Through(RouteTo(routing, "7.9.9.9"), devices[2], "10.2.2.254"),
+             "7.9.9.9 should take the /8 over the default route");
+
+    routing->AddNetworkRouteTo("9.0.0.0", "255.0.0.0", "10.1.1.250", 1, 5);
+    routing->AddNetworkRouteTo("9.0.0.0", "255.0.0.0", "10.2.2.250", 2, 1);
+    c.Expect(Through(RouteTo(routing, "9.1.1.1"), devices[2], "10.2.2.250"),
+             "9.1.1.1 should take the metric 1 route over the metric 5 one");
+
+    c.Expect(Through(RouteTo(routing, "9.1.1.1", devices[1]), devices[1], "10.1.1.250"),
+             "through interface 1, 9.1.1.1 should take the metric 5 route");
+    c.Expect(Through(RouteTo(routing, "7.1.2.3", devices[2]), devices[2], "10.2.2.254"),
+             "through interface 2, 7.1.2.3 should fall back to the /8");
+    c.Expect(!RouteTo(routing, "8.8.8.8", devices[2]),
+             "through interface 2 there is no default route");
+
+    uint32_t routes = routing->GetNRoutes();
+    ipv4->SetDown(2);
+    c.Expect(routing->GetNRoutes() == routes - 3,
+             "going down should remove the /8, the metric 1 route and 10.2.2.0/24");
+    c.Expect(Through(RouteTo(routing, "7.9.9.9"), devices[1], "10.1.1.254"),
+             "without interface 2, 7.9.9.9 should take the default route");
+    c.Expect(Through(RouteTo(routing, "7.1.2.3"), devices[1], "10.1.1.253"),
+             "without interface 2, 7.1.2.3 should keep the /24");
+    c.Expect(Through(RouteTo(routing, "9.1.1.1"), devices[1], "10.1.1.250"),
+             "without interface 2, 9.1.1.1 should take the metric 5 route");
+    c.Expect(Through(RouteTo(routing, "10.1.1.7"), devices[1], "0.0.0.0"),
+             "10.1.1.7 should still be on link through interface 1");
+    c.Expect(Through(RouteTo(routing, "10.2.2.7"), devices[1], "10.1.1.254"),
+             "without 10.2.2.0/24, 10.2.2.7 should take the default route");
+}
+
+/// Every quantile of \p sketch within the relative accuracy of the exact one of \p values
+void
+ExpectQuantiles(Checker& c,
+                const LogBucketSketch& sketch,
+                std::vector<double> values,
+                const std::string& label)
+{
+    std::sort(values.begin(), values.end());
+    c.Expect(sketch.GetCount() == values.size(), label + ": count differs");
+    for (double q : {0.0, 0.01, 0.1, 0.5, 0.9, 0.95, 0.99, 0.999, 1.0})
+    {
+        // The rank GetQuantile() reads too, so the only error left is the bucket's
+        double exact = values[std::llround(q * (values.size() - 1))];
+        double estimate = sketch.GetQuantile(q);
+        double error = std::abs(estimate - exact) / exact;
+        std::ostringstream what;
+        what << label << ": quantile " << q << " is " << estimate << " instead of " << exact
+             << " (relative error " << error << ")";
+        c.Expect(error <= LogBucketSketch::RELATIVE_ACCURACY * (1 + 1e-9), what.str());
+    }
+}
+
+/// The 1% relative error of the quantiles, also once slices are merged
+void
+CheckLogBucketSketch(Checker& c)
+{
+    c.Expect(LogBucketSketch().GetQuantile(0.5) == 0.0, "an empty sketch should return 0");
+
+    std::mt19937_64 random(1);
+    std::uniform_real_distribution<double> uniform(1e-3, 0.1);
+    std::exponential_distribution<double> exponential(50.0); // 20 ms above the 1 ms floor
+    std::lognormal_distribution<double> lognormal(std::log(0.05), 1.0);
+    const uint32_t slices = 4;
+    const uint32_t valuesPerSlice = 25000;
+    for (std::string name : {"uniform", "exponential", "lognormal"})
+    {
+        std::vector<double> all;
+        LogBucketSketch merged;
+        for (uint32_t slice = 0; slice < slices; ++slice)
+        {
+            std::vector<double> values;
+            LogBucketSketch sketch;
+            for (uint32_t i = 0; i < valuesPerSlice; ++i)
+            {
+                double value = name == "uniform"       ? uniform(random)
+                               : name == "exponential" ? 1e-3 + exponential(random)
+                                                       : lognormal(random);
+                values.push_back(value);
+                sketch.Add(value);
+            }
+            if (slice == 0)
+            {
+                ExpectQuantiles(c, sketch, values, name + " slice");
+            }
+            merged.Merge(sketch);
+            all.insert(all.end(), values.begin(), values.end());
+        }
+        ExpectQuantiles(c, merged, all, name + " merged");
+    }
+}
+
+struct Check
+{
+    const char* name;
+    void (*run)(Checker&);
+};
+
+const Check CHECKS[] = {
+    {"trajectory-ns2", &CheckTrajectoryNs2},
+    {"tti-bucket-scheduler", &CheckTtiBucketScheduler},
+    {"trie-routing", &CheckTrieRouting},
+    {"log-bucket-sketch", &CheckLogBucketSketch},
+};
+
+} // namespace
+
+int
+SelfTest::Run(const std::string& names, std::ostream& os)
+{
+    std::vector<std::string> selected;
+    std::istringstream list(names);
+    for (std::string name; std::getline(list, name, ',');)
+    {
+        bool known = name == "all";
+        for (const Check& check : CHECKS)
+        {
+            known = known || name == check.name;
+        }
+        NS_ABORT_MSG_UNLESS(known, "Unknown --selfTest check " << name);
+        selected.push_back(name);
+    }
+
+    uint32_t failed = 0;
+    for (const Check& check : CHECKS)
+    {
+        bool run = false;
+        for (const std::string& name : selected)
+        {
+            run = run || name == "all" || name == check.name;
+        }
+        if (!run)
+        {
+            continue;
+        }
+        Checker checker;
+        check.run(checker);
+        Simulator::Destroy(); // no check leaves events behind for the next
+        const std::vector<std::string>& failures = checker.GetFailures();
+        os << (failures.empty() ? "PASS " : "FAIL ") << check.name << " ("
+           << checker.GetExpectations() - failures.size() << "/" << checker.GetExpectations()
+           << ")" << std::endl;
+        for (const std::string& failure : failures)
+        {
+            os << "    " << failure << std::endl;
+        }
+        failed += failures.empty() ? 0 : 1;
+    }
+    return failed == 0 ? 0 : 1;
+}
+
+} // namespace ns3
@@ -0,0 +1,34 @@
+/* self-test.h
+ *
+ * Consistency checks of the scenario's own components (--selfTest).
+ *
+ * A scratch program cannot register an ns-3 TestSuite, so the invariants of the parsers,
+ * event queues, routing and statistics written for this scenario are checked by this
+ * mode instead: each named check drives one component on small known inputs, outside
+ * any scenario, and compares it with a reference. "all" runs every check. One PASS /
+ * FAIL line per check goes to the stream, followed by the failed expectations.
+ */
+
+#ifndef SELF_TEST_H
+#define SELF_TEST_H
+
+#include <ostream>
+#include <string>
+
+namespace ns3
+{
+
+class SelfTest
+{
+  public:
+    /**
+     * Run the checks of \p names ("trajectory-ns2,...", or "all")
+     *
+     * \return 0 if every check passed, 1 otherwise
+     */
+    static int Run(const std::string& names, std::ostream& os);
+};
+
+} // namespace ns3
+
+#endif /* SELF_TEST_H */
@@ -0,0 +1,219 @@
+/* session-traffic-manager.cc
+ *
+ * See session-traffic-manager.h
+ */
+
+#include "session-traffic-manager.h"
+
+#include "ns3/abort.h"
+#include "ns3/double.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/log.h"
+#include "ns3/pointer.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+
+NS_LOG_COMPONENT_DEFINE("SessionTrafficManager");
+
+namespace ns3
+{
+
+NS_OBJECT_ENSURE_REGISTERED(SessionTrafficManager);
+
+TypeId
+SessionTrafficManager::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::SessionTrafficManager")
+            .SetParent<Object>()
+            .AddConstructor<SessionTrafficManager>()
+            .AddAttribute("SessionRate",
+                          "Session arrivals per second of an idle UE",
+                          DoubleValue(0.1),
+                          MakeDoubleAccessor(&SessionTrafficManager::m_sessionRate),
+                          MakeDoubleChecker<double>(0.0))
+            .AddAttribute("SessionDuration",
+                          "Seconds the sender of a session runs",
+                          StringValue("ns3::ExponentialRandomVariable[Mean=5]"),
+                          MakePointerAccessor(&SessionTrafficManager::m_duration),
+                          MakePointerChecker<RandomVariableStream>())
+            .AddAttribute("DrainTime",
+                          "How long a sink outlives its sender, for the packets in flight",
+                          TimeValue(MilliSeconds(500)),
+                          MakeTimeAccessor(&SessionTrafficManager::m_drainTime),
+                          MakeTimeChecker(Time(0)))
+            .AddAttribute("Port",
+                          "UDP port of the sinks",
+                          UintegerValue(8000),
+                          MakeUintegerAccessor(&SessionTrafficManager::m_port),
+                          MakeUintegerChecker<uint16_t>());
+    return tid;
+}
+
+SessionTrafficManager::SessionTrafficManager()
+    : m_sessionRate(0.1),
+      m_port(8000),
+      m_interArrival(CreateObject<ExponentialRandomVariable>()),
+      m_ueChoice(CreateObject<UniformRandomVariable>()),
+      m_started(0),
+      m_active(0),
+      m_peakActive(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+SessionTrafficManager::~SessionTrafficManager()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+SessionTrafficManager::Setup(const NodeContainer& ues,
+                             const std::vector<Ipv4Address>& addresses,
+                             Ptr<Node> server,
+                             const ObjectFactory& sender)
+{
+    NS_ABORT_MSG_UNLESS(ues.GetN() == addresses.size(), "One address per UE expected");
+    m_ues = ues;
+    m_addresses = addresses;
+    m_server = server;
+    m_senderFactory = sender;
+    m_sinkFactory.SetTypeId("ns3::PacketSink");
+    m_sinkFactory.Set("Protocol", StringValue("ns3::UdpSocketFactory"));
+    m_sinkFactory.Set("Local", AddressValue(InetSocketAddress(Ipv4Address::GetAny(), m_port)));
+    m_sessions.assign(ues.GetN(), Session());
+}
+
+void
+SessionTrafficManager::Start(Time start, Time stop)
+{
+    m_stopTime = Simulator::Now() + stop;
+    m_arrivalEvent = Simulator::Schedule(start, &SessionTrafficManager::ScheduleArrival, this);
+}
+
+int64_t
+SessionTrafficManager::AssignStreams(int64_t stream)
+{
+    m_duration->SetStream(stream);
+    m_interArrival->SetStream(stream + 1);
+    m_ueChoice->SetStream(stream + 2);
+    return 3;
+}
+
+uint64_t
+SessionTrafficManager::GetSessions() const
+{
+    return m_started;
+}
+
+uint32_t
+SessionTrafficManager::GetActiveSessions() const
+{
+    return m_active;
+}
+
+uint32_t
+SessionTrafficManager::GetPeakActiveSessions() const
+{
+    return m_peakActive;
+}
+
+void
+SessionTrafficManager::DoDispose()
+{
+    Simulator::Cancel(m_arrivalEvent);
+    for (Session& session : m_sessions)
+    {
+        for (Ptr<Application> app : {session.sink, session.sender})
+        {
+            if (app)
+            {
+                app->Dispose();
+            }
+        }
+    }
+    m_sessions.clear();
+    m_ues = NodeContainer();
+    m_server = nullptr;
+    Object::DoDispose();
+}
+
+void
+SessionTrafficManager::ScheduleArrival()
+{
+    double rate = m_sessionRate * m_ues.GetN();
+    if (rate <= 0)
+    {
+        return;
+    }
+    Time next = Seconds(m_interArrival->GetValue(1.0 / rate, 0));
+    if (Simulator::Now() + next < m_stopTime)
+    {
+        m_arrivalEvent = Simulator::Schedule(next, &SessionTrafficManager::Arrival, this);
+    }
+}
+
+void
+SessionTrafficManager::Arrival()
+{
+    ScheduleArrival();
+    uint32_t ue = m_ueChoice->GetInteger(0, m_ues.GetN() - 1);
+    if (m_sessions[ue].sink)
+    {
+        return; // busy: thinned away
+    }
+    Time duration = std::min(Seconds(m_duration->GetValue()), m_stopTime - Simulator::Now());
+    if (!duration.IsStrictlyPositive())
+    {
+        return; // a zero stop time would mean "never stop"
+    }
+    NS_LOG_LOGIC("session " << m_started << " to UE " << ue << " for " << duration.As(Time::S));
+
+    Session& session = m_sessions[ue];
+    m_senderFactory.Set("Remote", AddressValue(InetSocketAddress(m_addresses[ue], m_port)));
+    session.sender = m_senderFactory.Create<Application>();
+    session.sender->SetNode(m_server);
+    session.sender->SetStartTime(Time(0));
+    session.sender->SetStopTime(duration);
+    session.sink = m_sinkFactory.Create<Application>();
+    session.sink->SetNode(m_ues.Get(ue));
+    session.sink->SetStartTime(Time(0));
+    session.sink->SetStopTime(duration + m_drainTime);
+
+    // Initialized as Node::AddApplication would, in their node's context
+    Simulator::ScheduleWithContext(m_server->GetId(),
+                                   Time(0),
+                                   &Application::Initialize,
+                                   session.sender);
+    Simulator::ScheduleWithContext(m_ues.Get(ue)->GetId(),
+                                   Time(0),
+                                   &SessionTrafficManager::StartSink,
+                                   this,
+                                   ue,
+                                   duration + m_drainTime);
+    ++m_started;
+    m_peakActive = std::max(m_peakActive, ++m_active);
+}
+
+void
+SessionTrafficManager::StartSink(uint32_t ue, Time lifetime)
+{
+    m_sessions[ue].sink->Initialize();
+    // Scheduled after both stop events, so it runs after them even when they coincide
+    Simulator::Schedule(lifetime, &SessionTrafficManager::EndSession, this, ue);
+}
+
+void
+SessionTrafficManager::EndSession(uint32_t ue)
+{
+    Session& session = m_sessions[ue];
+    session.sender->Dispose();
+    session.sink->Dispose();
+    m_sessions[ue] = Session();
+    --m_active;
+}
+
+} // namespace ns3
@@ -0,0 +1,107 @@
+/* session-traffic-manager.h
+ *
+ * On-demand web traffic: applications exist only while a session is active
+ * (--webActivation=ondemand).
+ *
+ * Instead of a sink on every UE and an always-running sender per UE on the server, one
+ * aggregated Poisson process of rate SessionRate x UEs draws session arrivals and
+ * assigns each to a UE picked uniformly; an arrival for a UE that already has a session
+ * is discarded. By Poisson thinning every UE then idles for an exponential time of mean
+ * 1 / SessionRate between sessions, at the cost of one event per arrival for the whole
+ * population. A session creates a PacketSink (and its UDP socket) on the UE and a sender
+ * from the given factory on the server, runs the sender for a SessionDuration draw, keeps
+ * the sink DrainTime longer for the packets still in flight and then disposes of both,
+ * so applications, sockets and their events scale with the active sessions rather than
+ * with the UEs.
+ *
+ * The applications are not added to their nodes (ns-3 cannot remove an application from
+ * a node): the manager sets their node, initializes them in the node's context and owns
+ * them for the session.
+ */
+
+#ifndef SESSION_TRAFFIC_MANAGER_H
+#define SESSION_TRAFFIC_MANAGER_H
+
+#include "ns3/application.h"
+#include "ns3/event-id.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/node-container.h"
+#include "ns3/nstime.h"
+#include "ns3/object-factory.h"
+#include "ns3/object.h"
+#include "ns3/random-variable-stream.h"
+
+#include <vector>
+
+namespace ns3
+{
+
+class SessionTrafficManager : public Object
+{
+  public:
+    static TypeId GetTypeId();
+
+    SessionTrafficManager();
+    ~SessionTrafficManager() override;
+
+    /**
+     * \param ues nodes receiving the sessions
+     * \param addresses address of each of \p ues, in the same order
+     * \param server node the senders run on
+     * \param sender factory of the sender application; its "Remote" is set per session
+     */
+    void Setup(const NodeContainer& ues,
+               const std::vector<Ipv4Address>& addresses,
+               Ptr<Node> server,
+               const ObjectFactory& sender);
+
+    /// First arrival process draw after \p start; sessions end by \p stop (both from now)
+    void Start(Time start, Time stop);
+
+    int64_t AssignStreams(int64_t stream);
+
+    /// Sessions started so far, active now and at most active at once
+    uint64_t GetSessions() const;
+    uint32_t GetActiveSessions() const;
+    uint32_t GetPeakActiveSessions() const;
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    struct Session
+    {
+        Ptr<Application> sink;
+        Ptr<Application> sender;
+    };
+
+    void ScheduleArrival();
+    void Arrival();
+    /// Runs in the UE's context, after the sender was initialized in the server's
+    void StartSink(uint32_t ue, Time lifetime);
+    void EndSession(uint32_t ue);
+
+    double m_sessionRate;
+    Ptr<RandomVariableStream> m_duration;
+    Time m_drainTime;
+    uint16_t m_port;
+    Ptr<ExponentialRandomVariable> m_interArrival;
+    Ptr<UniformRandomVariable> m_ueChoice;
+
+    NodeContainer m_ues;
+    std::vector<Ipv4Address> m_addresses;
+    Ptr<Node> m_server;
+    ObjectFactory m_senderFactory;
+    ObjectFactory m_sinkFactory;
+    std::vector<Session> m_sessions; ///< per UE, empty while idle
+    Time m_stopTime;                 ///< absolute
+    EventId m_arrivalEvent;
+
+    uint64_t m_started;
+    uint32_t m_active;
+    uint32_t m_peakActive;
+};
+
+} // namespace ns3
+
+#endif /* SESSION_TRAFFIC_MANAGER_H */
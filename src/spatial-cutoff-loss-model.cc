@@ -0,0 +1,171 @@
+/* spatial-cutoff-loss-model.cc
+ *
+ * See spatial-cutoff-loss-model.h
+ */
+
+#include "spatial-cutoff-loss-model.h"
+
+#include "ns3/double.h"
+#include "ns3/log.h"
+#include "ns3/mobility-model.h"
+#include "ns3/object-factory.h"
+
+NS_LOG_COMPONENT_DEFINE("SpatialCutoffLossModel");
+
+namespace ns3
+{
+
+NS_OBJECT_ENSURE_REGISTERED(SpatialCutoffLossModel);
+
+TypeId
+SpatialCutoffLossModel::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::SpatialCutoffLossModel")
+            .SetParent<PropagationLossModel>()
+            .AddConstructor<SpatialCutoffLossModel>()
+            .AddAttribute("Model",
+                          "Wrapped propagation loss model",
+                          TypeIdValue(FriisPropagationLossModel::GetTypeId()),
+                          MakeTypeIdAccessor(&SpatialCutoffLossModel::m_modelTypeId),
+                          MakeTypeIdChecker())
+            .AddAttribute("Frequency",
+                          "Carrier frequency (Hz), passed on to the wrapped model",
+                          DoubleValue(2160e6),
+                          MakeDoubleAccessor(&SpatialCutoffLossModel::SetFrequency,
+                                             &SpatialCutoffLossModel::GetFrequency),
+                          MakeDoubleChecker<double>())
+            .AddAttribute("CutoffDistance",
+                          "Pairs farther apart than this (m) get CUTOFF_LOSS_DB (0 = no cutoff)",
+                          DoubleValue(0.0),
+                          MakeDoubleAccessor(&SpatialCutoffLossModel::m_cutoff),
+                          MakeDoubleChecker<double>(0.0))
+            .AddAttribute("MovementThreshold",
+                          "Cached losses are reused until an end moves this far (m, 0 = no cache)",
+                          DoubleValue(0.0),
+                          MakeDoubleAccessor(&SpatialCutoffLossModel::m_threshold),
+                          MakeDoubleChecker<double>(0.0));
+    return tid;
+}
+
+SpatialCutoffLossModel::SpatialCutoffLossModel()
+    : m_frequency(2160e6),
+      m_cutoff(0.0),
+      m_threshold(0.0),
+      m_cutoffPairs(0),
+      m_cacheHits(0),
+      m_evaluations(0)
+{
+}
+
+SpatialCutoffLossModel::~SpatialCutoffLossModel()
+{
+}
+
+void
+SpatialCutoffLossModel::DoDispose()
+{
+    NS_LOG_INFO("cutoff pairs " << m_cutoffPairs << ", cache hits " << m_cacheHits
+                                << ", evaluations " << m_evaluations);
+    m_model = nullptr;
+    m_cache.clear();
+    PropagationLossModel::DoDispose();
+}
+
+double
+SpatialCutoffLossModel::GetMaxLossDb()
+{
+    return CUTOFF_LOSS_DB / 2;
+}
+
+uint64_t
+SpatialCutoffLossModel::GetCutoffPairs() const
+{
+    return m_cutoffPairs;
+}
+
+uint64_t
+SpatialCutoffLossModel::GetCacheHits() const
+{
+    return m_cacheHits;
+}
+
+uint64_t
+SpatialCutoffLossModel::GetEvaluations() const
+{
+    return m_evaluations;
+}
+
+Ptr<PropagationLossModel>
+SpatialCutoffLossModel::GetModel() const
+{
+    if (!m_model)
+    {
+        ObjectFactory factory(m_modelTypeId.GetName());
+        m_model = factory.Create<PropagationLossModel>();
+        m_model->SetAttributeFailSafe("Frequency", DoubleValue(m_frequency));
+    }
+    return m_model;
+}
+
+void
+SpatialCutoffLossModel::SetFrequency(double frequency)
+{
+    m_frequency = frequency;
+    if (m_model)
+    {
+        m_model->SetAttributeFailSafe("Frequency", DoubleValue(m_frequency));
+    }
+    m_cache.clear();
+}
+
+double
+SpatialCutoffLossModel::GetFrequency() const
+{
+    return m_frequency;
+}
+
+double
+SpatialCutoffLossModel::DoCalcRxPower(double txPowerDbm,
+                                      Ptr<MobilityModel> a,
+                                      Ptr<MobilityModel> b) const
+{
+    Vector pa = a->GetPosition();
+    Vector pb = b->GetPosition();
+
+    if (m_cutoff > 0)
+    {
+        if (CalculateDistanceSquared(pa, pb) > m_cutoff * m_cutoff)
+        {
+            ++m_cutoffPairs;
+            return txPowerDbm - CUTOFF_LOSS_DB;
+        }
+    }
+
+    if (m_threshold <= 0)
+    {
+        ++m_evaluations;
+        return GetModel()->CalcRxPower(txPowerDbm, a, b);
+    }
+
+    const double threshold2 = m_threshold * m_threshold;
+    auto it = m_cache.find({PeekPointer(a), PeekPointer(b)});
+    if (it != m_cache.end() && CalculateDistanceSquared(pa, it->second.a) <= threshold2 &&
+        CalculateDistanceSquared(pb, it->second.b) <= threshold2)
+    {
+        ++m_cacheHits;
+        return txPowerDbm - it->second.lossDb;
+    }
+    ++m_evaluations;
+    double rxPowerDbm = GetModel()->CalcRxPower(txPowerDbm, a, b);
+    m_cache[{PeekPointer(a), PeekPointer(b)}] = Entry{pa, pb, txPowerDbm - rxPowerDbm};
+    return rxPowerDbm;
+}
+
+int64_t
+SpatialCutoffLossModel::DoAssignStreams(int64_t stream)
+{
+    return GetModel()->AssignStreams(stream);
+}
+
+} // namespace ns3
@@ -0,0 +1,98 @@
+/* spatial-cutoff-loss-model.h
+ *
+ * Interference cutoff and path-loss cache around the LTE path-loss model
+ * (--interferenceCutoff, --pathlossCacheThreshold).
+ *
+ * The spectrum channel evaluates the path loss from every transmitter to every other
+ * PHY on each transmission and, for each of them, copies the PSD, schedules a StartRx
+ * event and adds the signal to the receiver's interference chunk. This wrapper reports
+ * CUTOFF_LOSS_DB for pairs farther apart than CutoffDistance; with the channel's
+ * MaxLossDb below it (see GetMaxLossDb()) the channel drops those pairs before any of the
+ * per-receiver work, so with 100+ sites each transmission is only delivered to the PHYs
+ * around it. The channel still calls the loss model for every receiver: a cut-off pair
+ * costs one squared-distance compare instead of the wrapped model, not nothing.
+ *
+ * Only pairs within the cutoff are evaluated or cached. The wrapped model's result is
+ * cached per (tx, rx) mobility pair and reused until either end has moved more than
+ * MovementThreshold from where it was computed, so static eNB pairs and parked UEs are
+ * evaluated once.
+ */
+
+#ifndef SPATIAL_CUTOFF_LOSS_MODEL_H
+#define SPATIAL_CUTOFF_LOSS_MODEL_H
+
+#include "ns3/propagation-loss-model.h"
+#include "ns3/type-id.h"
+#include "ns3/vector.h"
+
+#include <functional>
+#include <unordered_map>
+#include <utility>
+
+namespace ns3
+{
+
+class SpatialCutoffLossModel : public PropagationLossModel
+{
+  public:
+    static TypeId GetTypeId();
+
+    SpatialCutoffLossModel();
+    ~SpatialCutoffLossModel() override;
+
+    /// Loss reported beyond the cutoff distance
+    static constexpr double CUTOFF_LOSS_DB = 1000.0;
+    /// Spectrum channel MaxLossDb that drops cut-off pairs but no real link
+    static double GetMaxLossDb();
+
+    /// Pairs rejected by the cutoff, cache hits and wrapped-model evaluations so far
+    uint64_t GetCutoffPairs() const;
+    uint64_t GetCacheHits() const;
+    uint64_t GetEvaluations() const;
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    double DoCalcRxPower(double txPowerDbm,
+                         Ptr<MobilityModel> a,
+                         Ptr<MobilityModel> b) const override;
+    int64_t DoAssignStreams(int64_t stream) override;
+
+    Ptr<PropagationLossModel> GetModel() const;
+    /// Forwarded to the wrapped model, which LteHelper cannot see
+    void SetFrequency(double frequency);
+    double GetFrequency() const;
+
+    struct Entry
+    {
+        Vector a; ///< positions the loss was computed at
+        Vector b;
+        double lossDb;
+    };
+
+    struct PairHash
+    {
+        size_t operator()(const std::pair<const MobilityModel*, const MobilityModel*>& p) const
+        {
+            return std::hash<const void*>()(p.first) * 31 + std::hash<const void*>()(p.second);
+        }
+    };
+
+    TypeId m_modelTypeId;
+    double m_frequency;
+    double m_cutoff;
+    double m_threshold;
+    mutable Ptr<PropagationLossModel> m_model;
+    mutable std::unordered_map<std::pair<const MobilityModel*, const MobilityModel*>,
+                               Entry,
+                               PairHash>
+        m_cache;
+    mutable uint64_t m_cutoffPairs;
+    mutable uint64_t m_cacheHits;
+    mutable uint64_t m_evaluations;
+};
+
+} // namespace ns3
+
+#endif /* SPATIAL_CUTOFF_LOSS_MODEL_H */
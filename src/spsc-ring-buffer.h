@@ -0,0 +1,88 @@
+/* spsc-ring-buffer.h
+ *
+ * Bounded, preallocated, lock-free single-producer / single-consumer queue.
+ *
+ * One thread may call TryPush() and one other thread TryPop(); neither ever blocks or
+ * allocates. The capacity is rounded up to a power of two and one slot is kept free to
+ * tell a full ring from an empty one.
+ */
+
+#ifndef SPSC_RING_BUFFER_H
+#define SPSC_RING_BUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace ns3
+{
+
+template <typename T>
+class SpscRingBuffer
+{
+  public:
+    explicit SpscRingBuffer(size_t capacity)
+        : m_mask(RoundUpPowerOfTwo(capacity + 1) - 1),
+          m_slots(m_mask + 1),
+          m_head(0),
+          m_tail(0)
+    {
+    }
+
+    SpscRingBuffer(const SpscRingBuffer&) = delete;
+    SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+    /// Producer side; returns false (and drops \p item) if the ring is full
+    bool TryPush(const T& item)
+    {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        size_t next = (tail + 1) & m_mask;
+        if (next == m_head.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        m_slots[tail] = item;
+        m_tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    /// Consumer side; returns false if the ring is empty
+    bool TryPop(T& item)
+    {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        item = m_slots[head];
+        m_head.store((head + 1) & m_mask, std::memory_order_release);
+        return true;
+    }
+
+    /// Number of items the ring can hold
+    size_t GetCapacity() const
+    {
+        return m_mask;
+    }
+
+  private:
+    static size_t RoundUpPowerOfTwo(size_t n)
+    {
+        size_t p = 1;
+        while (p < n)
+        {
+            p <<= 1;
+        }
+        return p;
+    }
+
+    const size_t m_mask;
+    std::vector<T> m_slots;
+    // Producer and consumer indices on separate cache lines to avoid false sharing
+    alignas(64) std::atomic<size_t> m_head; ///< next slot to pop (written by the consumer)
+    alignas(64) std::atomic<size_t> m_tail; ///< next slot to push (written by the producer)
+};
+
+} // namespace ns3
+
+#endif /* SPSC_RING_BUFFER_H */
@@ -0,0 +1,168 @@
+/* steady-state-detector.cc
+ *
+ * See steady-state-detector.h
+ */
+
+#include "steady-state-detector.h"
+
+#include "sweep-runner.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+#include <cmath>
+#include <limits>
+
+NS_LOG_COMPONENT_DEFINE("SteadyStateDetector");
+
+namespace ns3
+{
+
+SteadyStateDetector::SteadyStateDetector(KpiAggregator& aggregator,
+                                         uint32_t windowSlices,
+                                         double tolerance,
+                                         uint32_t batches,
+                                         Time minTime)
+    : m_aggregator(aggregator),
+      m_windowSlices(windowSlices),
+      m_tolerance(tolerance),
+      m_batches(batches),
+      m_minTime(minTime),
+      m_slicesSeen(0),
+      m_series(2 * aggregator.GetClasses().size()),
+      m_converged(false)
+{
+    NS_ABORT_MSG_IF(m_batches < 2, "Steady-state detection needs at least 2 batches");
+    m_aggregator.SetWindowCallback(MakeCallback(&SteadyStateDetector::WindowClosed, this));
+}
+
+bool
+SteadyStateDetector::HasConverged() const
+{
+    return m_converged;
+}
+
+Time
+SteadyStateDetector::GetConvergenceTime() const
+{
+    return m_convergenceTime;
+}
+
+uint32_t
+SteadyStateDetector::MserTruncation(const std::vector<double>& series)
+{
+    const uint32_t n = series.size();
+    if (n < 2)
+    {
+        return 0;
+    }
+    // Suffix sums give the mean and squared deviation of series[d..] in O(1) per d
+    std::vector<double> sum(n + 1, 0.0);
+    std::vector<double> sumSquares(n + 1, 0.0);
+    for (uint32_t i = n; i-- > 0;)
+    {
+        sum[i] = sum[i + 1] + series[i];
+        sumSquares[i] = sumSquares[i + 1] + series[i] * series[i];
+    }
+    uint32_t best = 0;
+    double bestValue = std::numeric_limits<double>::infinity();
+    for (uint32_t d = 0; d <= n / 2; ++d)
+    {
+        double count = n - d;
+        double deviation = sumSquares[d] - sum[d] * sum[d] / count;
+        double value = deviation / (count * count);
+        if (value < bestValue)
+        {
+            bestValue = value;
+            best = d;
+        }
+    }
+    return best;
+}
+
+bool
+SteadyStateDetector::BatchMeans(const std::vector<double>& series,
+                                uint32_t first,
+                                uint32_t batches,
+                                double& mean,
+                                double& halfWidth)
+{
+    uint32_t n = series.size() - first;
+    if (n < batches)
+    {
+        return false;
+    }
+    // Equal batches; the oldest samples that do not fill a batch are dropped
+    uint32_t batchSize = n / batches;
+    first += n - batchSize * batches;
+    std::vector<double> means(batches, 0.0);
+    for (uint32_t b = 0; b < batches; ++b)
+    {
+        for (uint32_t i = 0; i < batchSize; ++i)
+        {
+            means[b] += series[first + b * batchSize + i];
+        }
+        means[b] /= batchSize;
+    }
+    mean = 0.0;
+    for (double m : means)
+    {
+        mean += m;
+    }
+    mean /= batches;
+    double variance = 0.0;
+    for (double m : means)
+    {
+        variance += (m - mean) * (m - mean);
+    }
+    variance /= batches - 1;
+    halfWidth = SweepRunner::TCritical95(batches - 1) * std::sqrt(variance / batches);
+    return true;
+}
+
+bool
+SteadyStateDetector::Converged(const std::vector<double>& series) const
+{
+    double mean;
+    double halfWidth;
+    if (!BatchMeans(series, MserTruncation(series), m_batches, mean, halfWidth))
+    {
+        return false;
+    }
+    // Series that stayed at zero (a class without traffic or without delay samples)
+    // do not hold the run back
+    return mean == 0.0 ? halfWidth == 0.0 : halfWidth <= m_tolerance * std::fabs(mean);
+}
+
+void
+SteadyStateDetector::WindowClosed()
+{
+    if (m_converged || ++m_slicesSeen % m_windowSlices != 0)
+    {
+        return;
+    }
+    for (uint32_t c = 0; c < m_aggregator.GetClasses().size(); ++c)
+    {
+        KpiAggregator::WindowKpis kpis = m_aggregator.GetClassKpis(c);
+        m_series[2 * c].push_back(kpis.throughputMbps);
+        m_series[2 * c + 1].push_back(kpis.delayP50Ms);
+    }
+    if (Simulator::Now() < m_minTime)
+    {
+        return;
+    }
+    for (const std::vector<double>& series : m_series)
+    {
+        if (!Converged(series))
+        {
+            return;
+        }
+    }
+    m_converged = true;
+    m_convergenceTime = Simulator::Now();
+    NS_LOG_INFO("KPIs converged at " << m_convergenceTime.As(Time::S));
+    Simulator::Stop();
+}
+
+} // namespace ns3
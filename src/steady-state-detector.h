@@ -0,0 +1,79 @@
+/* steady-state-detector.h
+ *
+ * Ends the run once the windowed KPIs have converged (--steadyStateTolerance).
+ *
+ * After every non-overlapping KPI window the detector appends, per traffic class, the
+ * window's throughput and median delay to one series each. For each series it chooses
+ * the truncation point with the MSER rule (drop the first d samples that minimise the
+ * squared deviation of the rest divided by (n - d)^2, d at most n / 2) to discard the
+ * attach / slow-start transient, splits the remaining samples into `batches` batch means
+ * and computes a Student t 95% confidence interval on their mean. Once, for every series
+ * that is not all zero, the interval's half width is within `tolerance` of the mean (and
+ * at least minTime has been simulated), it calls Simulator::Stop(); the run's
+ * Simulator::Stop(simTime) remains the upper bound.
+ */
+
+#ifndef STEADY_STATE_DETECTOR_H
+#define STEADY_STATE_DETECTOR_H
+
+#include "kpi-aggregator.h"
+
+#include "ns3/nstime.h"
+
+#include <vector>
+
+namespace ns3
+{
+
+class SteadyStateDetector
+{
+  public:
+    /**
+     * \param aggregator KPI source; the detector installs its window callback
+     * \param windowSlices slices per aggregator window, so only non-overlapping
+     *        windows are sampled
+     * \param tolerance relative half width of the 95% interval that counts as converged
+     * \param batches number of batch means after truncation (at least 2)
+     * \param minTime simulated time before the run may be stopped
+     */
+    SteadyStateDetector(KpiAggregator& aggregator,
+                        uint32_t windowSlices,
+                        double tolerance,
+                        uint32_t batches,
+                        Time minTime);
+
+    /// Whether the detector stopped the simulation
+    bool HasConverged() const;
+    /// Simulated time at which it did
+    Time GetConvergenceTime() const;
+
+    /// MSER truncation point of \p series
+    static uint32_t MserTruncation(const std::vector<double>& series);
+    /**
+     * Mean and 95% half width of the batch means of series[first..]; false if fewer
+     * samples than batches are left
+     */
+    static bool BatchMeans(const std::vector<double>& series,
+                           uint32_t first,
+                           uint32_t batches,
+                           double& mean,
+                           double& halfWidth);
+
+  private:
+    void WindowClosed();
+    bool Converged(const std::vector<double>& series) const;
+
+    KpiAggregator& m_aggregator;
+    uint32_t m_windowSlices;
+    double m_tolerance;
+    uint32_t m_batches;
+    Time m_minTime;
+    uint32_t m_slicesSeen;
+    std::vector<std::vector<double>> m_series; ///< throughput, delay per class
+    bool m_converged;
+    Time m_convergenceTime;
+};
+
+} // namespace ns3
+
+#endif /* STEADY_STATE_DETECTOR_H */
@@ -0,0 +1,414 @@
+/* sweep-runner.cc
+ *
+ * See sweep-runner.h
+ */
+
+#include "sweep-runner.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+NS_LOG_COMPONENT_DEFINE("SweepRunner");
+
+namespace ns3
+{
+
+namespace
+{
+
+std::vector<std::string>
+Split(const std::string& text, char separator)
+{
+    std::vector<std::string> items;
+    std::istringstream in(text);
+    std::string item;
+    while (std::getline(in, item, separator))
+    {
+        if (!item.empty())
+        {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+} // namespace
+
+SweepRunner::SweepRunner(const std::string& grid,
+                         uint32_t jobs,
+                         const std::string& outputDir,
+                         const std::string& flowStatsExtension,
+                         const std::map<std::string, std::string>& outputFiles)
+    : m_jobs(jobs),
+      m_outputDir(outputDir),
+      m_flowStatsExtension(flowStatsExtension),
+      m_outputFiles(outputFiles)
+{
+    if (m_jobs == 0)
+    {
+        m_jobs = std::max(1U, std::thread::hardware_concurrency());
+    }
+    ParseGrid(grid);
+}
+
+void
+SweepRunner::ParseGrid(const std::string& grid)
+{
+    for (const std::string& entry : Split(grid, ';'))
+    {
+        size_t eq = entry.find('=');
+        NS_ABORT_MSG_IF(eq == std::string::npos || eq == 0 || eq + 1 == entry.size(),
+                        "Bad sweep entry '" << entry << "', expected name=value[,value...]");
+        std::string name = entry.substr(0, eq);
+        std::vector<std::string> values = Split(entry.substr(eq + 1), ',');
+
+        if (name == "runs")
+        {
+            for (const std::string& v : values)
+            {
+                size_t dash = v.find('-');
+                uint32_t first = std::stoul(v.substr(0, dash));
+                uint32_t last = dash == std::string::npos ? first : std::stoul(v.substr(dash + 1));
+                NS_ABORT_MSG_IF(last < first, "Bad run range " << v);
+                for (uint32_t r = first; r <= last; ++r)
+                {
+                    m_runs.push_back(r);
+                }
+            }
+            continue;
+        }
+        NS_ABORT_MSG_IF(values.empty(), "No values for sweep parameter " << name);
+        m_params.emplace_back(name, values);
+    }
+    if (m_runs.empty())
+    {
+        m_runs.push_back(1);
+    }
+
+    // Cartesian product of the parameter values, last parameter varying fastest
+    m_points.assign(1, std::vector<std::string>());
+    for (const auto& param : m_params)
+    {
+        std::vector<std::vector<std::string>> next;
+        next.reserve(m_points.size() * param.second.size());
+        for (const auto& point : m_points)
+        {
+            for (const std::string& value : param.second)
+            {
+                next.push_back(point);
+                next.back().push_back(value);
+            }
+        }
+        m_points.swap(next);
+    }
+}
+
+std::vector<SweepRunner::Job>
+SweepRunner::BuildJobs(int argc, char* argv[]) const
+{
+    // Arguments shared by every child: everything but the sweep options and the
+    // options the runner sets per job
+    std::set<std::string> perJob = {"RngRun", "runSummaryFile", "flowStatsFile"};
+    for (const auto& param : m_params)
+    {
+        perJob.insert(param.first);
+    }
+    for (const auto& output : m_outputFiles)
+    {
+        NS_ABORT_MSG_IF(perJob.count(output.first), "Cannot sweep --" << output.first);
+        perJob.insert(output.first);
+    }
+    std::vector<std::string> common;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        std::string name = arg.substr(0, arg.find('='));
+        name.erase(0, name.find_first_not_of('-'));
+        if (name.rfind("sweep", 0) == 0 || perJob.count(name))
+        {
+            continue;
+        }
+        common.push_back(arg);
+    }
+
+    std::vector<Job> jobs;
+    for (uint32_t p = 0; p < m_points.size(); ++p)
+    {
+        for (uint32_t run : m_runs)
+        {
+            std::ostringstream tag;
+            tag << m_outputDir << "/point" << p << "-run" << run;
+
+            Job job;
+            job.point = p;
+            job.run = run;
+            job.summaryFile = tag.str() + "-summary.txt";
+            job.args = common;
+            for (uint32_t k = 0; k < m_params.size(); ++k)
+            {
+                job.args.push_back("--" + m_params[k].first + "=" + m_points[p][k]);
+            }
+            job.args.push_back("--RngRun=" + std::to_string(run));
+            job.args.push_back("--runSummaryFile=" + job.summaryFile);
+            job.args.push_back("--flowStatsFile=" + tag.str() + "-flowmon." + m_flowStatsExtension);
+            for (const auto& output : m_outputFiles)
+            {
+                // Only the file name: the job's files all live in the sweep directory
+                std::string fileName = output.second.substr(output.second.rfind('/') + 1);
+                job.args.push_back("--" + output.first + "=" +
+                                   (fileName.empty() ? "" : tag.str() + "-" + fileName));
+            }
+            jobs.push_back(std::move(job));
+        }
+    }
+    return jobs;
+}
+
+int
+SweepRunner::Run(int argc, char* argv[], const std::string& summaryFile)
+{
+    if (mkdir(m_outputDir.c_str(), 0755) != 0 && errno != EEXIST)
+    {
+        NS_FATAL_ERROR("Cannot create sweep directory " << m_outputDir << ": "
+                                                         << std::strerror(errno));
+    }
+
+    std::vector<Job> jobs = BuildJobs(argc, argv);
+    std::vector<bool> succeeded(jobs.size(), false);
+    std::map<pid_t, size_t> running;
+    size_t next = 0;
+
+    std::cout << "sweep: " << m_points.size() << " grid points x " << m_runs.size()
+              << " runs on " << m_jobs << " workers" << std::endl;
+
+    while (next < jobs.size() || !running.empty())
+    {
+        while (next < jobs.size() && running.size() < m_jobs)
+        {
+            const Job& job = jobs[next];
+            std::vector<char*> childArgv;
+            childArgv.push_back(argv[0]);
+            for (const std::string& a : job.args)
+            {
+                childArgv.push_back(const_cast<char*>(a.c_str()));
+            }
+            childArgv.push_back(nullptr);
+
+            pid_t pid = fork();
+            NS_ABORT_MSG_IF(pid < 0, "fork() failed: " << std::strerror(errno));
+            if (pid == 0)
+            {
+                execv("/proc/self/exe", childArgv.data());
+                std::cerr << "execv failed: " << std::strerror(errno) << std::endl;
+                _exit(127);
+            }
+            NS_LOG_INFO("started point " << job.point << " run " << job.run << " as pid " << pid);
+            running[pid] = next++;
+        }
+
+        int status = 0;
+        pid_t pid = waitpid(-1, &status, 0);
+        if (pid < 0)
+        {
+            NS_ABORT_MSG_IF(errno != EINTR, "waitpid() failed: " << std::strerror(errno));
+            continue;
+        }
+        auto it = running.find(pid);
+        if (it == running.end())
+        {
+            continue;
+        }
+        const Job& job = jobs[it->second];
+        succeeded[it->second] = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+        if (!succeeded[it->second])
+        {
+            std::cerr << "sweep: point " << job.point << " run " << job.run << " failed"
+                      << std::endl;
+        }
+        running.erase(it);
+    }
+
+    WriteTable(jobs, succeeded, summaryFile);
+    return std::all_of(succeeded.begin(), succeeded.end(), [](bool ok) { return ok; }) ? 0 : 1;
+}
+
+void
+SweepRunner::WriteTable(const std::vector<Job>& jobs,
+                        const std::vector<bool>& succeeded,
+                        const std::string& summaryFile) const
+{
+    // point -> KPI -> one value per successful run
+    std::vector<std::map<std::string, std::vector<double>>> samples(m_points.size());
+    std::set<std::string> kpiNames;
+    for (size_t j = 0; j < jobs.size(); ++j)
+    {
+        if (!succeeded[j])
+        {
+            continue;
+        }
+        for (const auto& kpi : ReadRunSummary(jobs[j].summaryFile))
+        {
+            samples[jobs[j].point][kpi.first].push_back(kpi.second);
+            kpiNames.insert(kpi.first);
+        }
+    }
+
+    std::ofstream out(summaryFile);
+    NS_ABORT_MSG_UNLESS(out.is_open(), "Cannot open sweep summary " << summaryFile);
+    for (const auto& param : m_params)
+    {
+        out << param.first << ',';
+    }
+    out << "runs";
+    for (const std::string& name : kpiNames)
+    {
+        out << ',' << name << "_mean," << name << "_ci95";
+    }
+    out << '\n';
+
+    for (uint32_t p = 0; p < m_points.size(); ++p)
+    {
+        for (const std::string& value : m_points[p])
+        {
+            out << value << ',';
+        }
+        size_t runs = 0;
+        for (const auto& kpi : samples[p])
+        {
+            runs = std::max(runs, kpi.second.size());
+        }
+        out << runs;
+
+        for (const std::string& name : kpiNames)
+        {
+            const std::vector<double>& v = samples[p][name];
+            double mean = 0;
+            for (double x : v)
+            {
+                mean += x;
+            }
+            mean = v.empty() ? 0.0 : mean / v.size();
+            double halfWidth = 0;
+            if (v.size() > 1)
+            {
+                double ss = 0;
+                for (double x : v)
+                {
+                    ss += (x - mean) * (x - mean);
+                }
+                double stddev = std::sqrt(ss / (v.size() - 1));
+                halfWidth = TCritical95(v.size() - 1) * stddev / std::sqrt(v.size());
+            }
+            out << ',' << mean << ',' << halfWidth;
+        }
+        out << '\n';
+    }
+    std::cout << "sweep: summary written to " << summaryFile << std::endl;
+}
+
+int
+SweepRunner::ForkReplications(uint32_t count, uint32_t jobs, bool& allSucceeded)
+{
+    if (jobs == 0)
+    {
+        jobs = std::max(1U, std::thread::hardware_concurrency());
+    }
+    std::cout.flush();
+    std::cerr.flush();
+
+    allSucceeded = true;
+    uint32_t next = 0;
+    uint32_t running = 0;
+    while (next < count || running > 0)
+    {
+        while (next < count && running < jobs)
+        {
+            pid_t pid = fork();
+            NS_ABORT_MSG_IF(pid < 0, "fork() failed: " << std::strerror(errno));
+            if (pid == 0)
+            {
+                return static_cast<int>(next);
+            }
+            NS_LOG_INFO("replication " << next << " runs as pid " << pid);
+            ++next;
+            ++running;
+        }
+
+        int status = 0;
+        pid_t pid = waitpid(-1, &status, 0);
+        if (pid < 0)
+        {
+            NS_ABORT_MSG_IF(errno != EINTR, "waitpid() failed: " << std::strerror(errno));
+            continue;
+        }
+        --running;
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        {
+            std::cerr << "replication process " << pid << " failed" << std::endl;
+            allSucceeded = false;
+        }
+    }
+    return -1;
+}
+
+void
+SweepRunner::WriteRunSummary(const std::string& fileName, const Kpis& kpis)
+{
+    std::ofstream out(fileName);
+    NS_ABORT_MSG_UNLESS(out.is_open(), "Cannot open run summary " << fileName);
+    out.precision(12);
+    for (const auto& kpi : kpis)
+    {
+        out << kpi.first << '=' << kpi.second << '\n';
+    }
+}
+
+SweepRunner::Kpis
+SweepRunner::ReadRunSummary(const std::string& fileName)
+{
+    Kpis kpis;
+    std::ifstream in(fileName);
+    std::string line;
+    while (std::getline(in, line))
+    {
+        size_t eq = line.find('=');
+        if (eq != std::string::npos)
+        {
+            kpis[line.substr(0, eq)] = std::stod(line.substr(eq + 1));
+        }
+    }
+    return kpis;
+}
+
+double
+SweepRunner::TCritical95(uint32_t degreesOfFreedom)
+{
+    static const double table[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306,
+                                   2.262,  2.228, 2.201, 2.179, 2.160, 2.145, 2.131, 2.120,
+                                   2.110,  2.101, 2.093, 2.086, 2.080, 2.074, 2.069, 2.064,
+                                   2.060,  2.056, 2.052, 2.048, 2.045, 2.042};
+    if (degreesOfFreedom == 0)
+    {
+        return 0.0;
+    }
+    if (degreesOfFreedom <= 30)
+    {
+        return table[degreesOfFreedom - 1];
+    }
+    return degreesOfFreedom <= 60 ? 2.000 : degreesOfFreedom <= 120 ? 1.980 : 1.960;
+}
+
+} // namespace ns3
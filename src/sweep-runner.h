@@ -0,0 +1,100 @@
+/* sweep-runner.h
+ *
+ * Parallel parameter sweep over independent replications (--sweep).
+ *
+ * The grid is a ';'-separated list of "option=value1,value2,..." entries; each option is
+ * passed to a child lte-simulation process as --option=value, so any scenario option can
+ * be swept (simTime, numUes, webRate, walkSpeed, ...). The special entry "runs=first-last"
+ * (or a comma list) selects the RngRun values. Every grid point x run is one child
+ * process; at most `jobs` children run at a time. Each child writes its KPIs to a
+ * key=value summary file and the runner merges them into one CSV row per grid point with
+ * the mean and 95% confidence half-width of every KPI across the runs. Concurrent children
+ * must not share an output file, so every file the scenario writes is given per job, under
+ * the sweep directory and prefixed with the job's point and run.
+ */
+
+#ifndef SWEEP_RUNNER_H
+#define SWEEP_RUNNER_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ns3
+{
+
+class SweepRunner
+{
+  public:
+    /// KPI name -> value, as written by WriteRunSummary()
+    using Kpis = std::map<std::string, double>;
+
+    /**
+     * \param grid the sweep grid, e.g. "numUes=10,100;webRate=1Mbps,5Mbps;runs=1-10"
+     * \param jobs maximum concurrent child processes (0 = number of cores)
+     * \param outputDir directory for per-run summary and flow statistics files
+     * \param flowStatsExtension extension of the per-run flow statistics file
+     * \param outputFiles option -> file name of the other per-run outputs; a job writes
+     *        <outputDir>/point<p>-run<r>-<file name>, an empty name (output off) stays off
+     */
+    SweepRunner(const std::string& grid,
+                uint32_t jobs,
+                const std::string& outputDir,
+                const std::string& flowStatsExtension,
+                const std::map<std::string, std::string>& outputFiles);
+
+    /**
+     * Run every replication and write the merged table to \p summaryFile.
+     *
+     * \p argc / \p argv are the arguments of this process; every argument except the
+     * --sweep* options and the per-job ones is forwarded unchanged to the children.
+     * \return 0 if every child succeeded, 1 otherwise
+     */
+    int Run(int argc, char* argv[], const std::string& summaryFile);
+
+    /**
+     * Fork \p count copies of the current process, at most \p jobs (0 = number of cores)
+     * alive at a time. Each child returns its replication index and carries on from the
+     * exact in-memory state of the parent; the parent returns -1 once every child exited.
+     *
+     * \param [out] allSucceeded in the parent, whether every child exited with status 0
+     */
+    static int ForkReplications(uint32_t count, uint32_t jobs, bool& allSucceeded);
+
+    /// Write \p kpis as key=value lines; used by a child run (--runSummaryFile)
+    static void WriteRunSummary(const std::string& fileName, const Kpis& kpis);
+    /// Read a file written by WriteRunSummary()
+    static Kpis ReadRunSummary(const std::string& fileName);
+
+    /// Student t critical value for a two-sided 95% interval
+    static double TCritical95(uint32_t degreesOfFreedom);
+
+  private:
+    struct Job
+    {
+        uint32_t point;              ///< index into m_points
+        uint32_t run;                ///< RngRun
+        std::vector<std::string> args;
+        std::string summaryFile;
+    };
+
+    void ParseGrid(const std::string& grid);
+    std::vector<Job> BuildJobs(int argc, char* argv[]) const;
+    void WriteTable(const std::vector<Job>& jobs,
+                    const std::vector<bool>& succeeded,
+                    const std::string& summaryFile) const;
+
+    std::vector<std::pair<std::string, std::vector<std::string>>> m_params;
+    std::vector<std::vector<std::string>> m_points; ///< one value per parameter
+    std::vector<uint32_t> m_runs;
+    uint32_t m_jobs;
+    std::string m_outputDir;
+    std::string m_flowStatsExtension;
+    std::map<std::string, std::string> m_outputFiles;
+};
+
+} // namespace ns3
+
+#endif /* SWEEP_RUNNER_H */
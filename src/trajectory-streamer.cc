@@ -0,0 +1,373 @@
+/* trajectory-streamer.cc
+ *
+ * See trajectory-streamer.h
+ */
+
+#include "trajectory-streamer.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+NS_LOG_COMPONENT_DEFINE("TrajectoryStreamer");
+
+namespace ns3
+{
+
+namespace
+{
+
+/// Returns the token starting at the first non-blank after \p pos and advances past it
+std::string_view
+NextToken(std::string_view line, size_t& pos)
+{
+    while (pos < line.size() && (line[pos] == ' ' || line[pos] == '\t'))
+    {
+        ++pos;
+    }
+    size_t begin = pos;
+    while (pos < line.size() && line[pos] != ' ' && line[pos] != '\t' && line[pos] != '"' &&
+           line[pos] != '\r')
+    {
+        ++pos;
+    }
+    return line.substr(begin, pos - begin);
+}
+
+/// The mapping is not NUL-terminated, so numbers are copied out before strtod
+bool
+ToDouble(std::string_view token, double& value)
+{
+    char buffer[64];
+    if (token.empty() || token.size() >= sizeof(buffer))
+    {
+        return false;
+    }
+    std::memcpy(buffer, token.data(), token.size());
+    buffer[token.size()] = '\0';
+    char* end = nullptr;
+    value = std::strtod(buffer, &end);
+    return end == buffer + token.size();
+}
+
+/// Value of attribute \p name in an XML element line, empty if absent
+std::string_view
+Attribute(std::string_view line, std::string_view name)
+{
+    size_t pos = 0;
+    while ((pos = line.find(name, pos)) != std::string_view::npos)
+    {
+        size_t value = pos + name.size();
+        bool delimited = pos > 0 && (line[pos - 1] == ' ' || line[pos - 1] == '\t');
+        if (delimited && line.substr(value, 2) == "=\"")
+        {
+            size_t close = line.find('"', value + 2);
+            if (close == std::string_view::npos)
+            {
+                return {};
+            }
+            return line.substr(value + 2, close - value - 2);
+        }
+        pos = value;
+    }
+    return {};
+}
+
+/// Node id of "$node_(<id>)" at \p pos, advancing past it
+std::string_view
+Ns2NodeId(std::string_view line, size_t& pos)
+{
+    size_t open = line.find("$node_(", pos);
+    if (open == std::string_view::npos)
+    {
+        return {};
+    }
+    open += 7;
+    size_t close = line.find(')', open);
+    if (close == std::string_view::npos)
+    {
+        return {};
+    }
+    pos = close + 1;
+    return line.substr(open, close - open);
+}
+
+} // namespace
+
+TrajectoryStreamer::TrajectoryStreamer(const std::string& fileName,
+                                       Format format,
+                                       uint32_t numUes,
+                                       WaypointSink sink,
+                                       Time lookahead)
+    : m_format(format),
+      m_numUes(numUes),
+      m_sink(sink),
+      m_lookahead(lookahead),
+      m_data(nullptr),
+      m_size(0),
+      m_cursor(0),
+      m_released(0),
+      m_timestep(0.0),
+      m_last(numUes),
+      m_pending(numUes, false),
+      m_waypoints(0)
+{
+    NS_ABORT_MSG_IF(m_lookahead <= Seconds(0), "Trajectory lookahead must be positive");
+
+    int fd = open(fileName.c_str(), O_RDONLY);
+    NS_ABORT_MSG_IF(fd < 0, "Cannot open vehicle trace " << fileName << ": " << strerror(errno));
+    struct stat st;
+    NS_ABORT_MSG_IF(fstat(fd, &st) != 0, "Cannot stat vehicle trace " << fileName);
+    m_size = st.st_size;
+    if (m_size > 0)
+    {
+        void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        NS_ABORT_MSG_IF(data == MAP_FAILED,
+                        "Cannot map vehicle trace " << fileName << ": " << strerror(errno));
+        m_data = static_cast<const char*>(data);
+        madvise(data, m_size, MADV_SEQUENTIAL);
+    }
+    close(fd);
+}
+
+TrajectoryStreamer::~TrajectoryStreamer()
+{
+    Simulator::Cancel(m_event);
+    if (m_data)
+    {
+        munmap(const_cast<char*>(m_data), m_size);
+    }
+}
+
+TrajectoryStreamer::Format
+TrajectoryStreamer::ParseFormat(const std::string& name)
+{
+    if (name == "fcd")
+    {
+        return SUMO_FCD;
+    }
+    if (name == "ns2")
+    {
+        return NS2;
+    }
+    NS_FATAL_ERROR("Unknown vehicle trace format " << name << " (expected fcd or ns2)");
+}
+
+void
+TrajectoryStreamer::Start()
+{
+    Refill();
+}
+
+uint32_t
+TrajectoryStreamer::GetVehicles() const
+{
+    return m_vehicleUe.size();
+}
+
+uint64_t
+TrajectoryStreamer::GetWaypoints() const
+{
+    return m_waypoints;
+}
+
+void
+TrajectoryStreamer::Refill()
+{
+    Fill((Simulator::Now() + m_lookahead).GetSeconds());
+    ReleaseConsumed();
+    if (m_cursor < m_size)
+    {
+        m_event = Simulator::Schedule(m_lookahead / 2, &TrajectoryStreamer::Refill, this);
+    }
+    NS_LOG_INFO("vehicles " << m_vehicleUe.size() << ", waypoints " << m_waypoints << ", "
+                            << m_cursor << "/" << m_size << " bytes parsed");
+}
+
+void
+TrajectoryStreamer::Fill(double horizon)
+{
+    while (m_cursor < m_size)
+    {
+        const char* begin = m_data + m_cursor;
+        const char* newline =
+            static_cast<const char*>(std::memchr(begin, '\n', m_size - m_cursor));
+        size_t length = newline ? newline - begin : m_size - m_cursor;
+        std::string_view line(begin, length);
+        size_t first = line.find_first_not_of(" \t");
+        line.remove_prefix(first == std::string_view::npos ? line.size() : first);
+
+        bool consumed = m_format == SUMO_FCD ? ParseFcdLine(line, horizon)
+                                             : ParseNs2Line(line, horizon);
+        if (!consumed)
+        {
+            break;
+        }
+        m_cursor += newline ? length + 1 : length;
+    }
+
+    // Initial ns-2 positions of nodes that have not moved yet
+    for (uint32_t ue = 0; ue < m_pending.size(); ++ue)
+    {
+        if (m_pending[ue])
+        {
+            Emit(ue, m_last[ue]);
+        }
+    }
+}
+
+bool
+TrajectoryStreamer::ParseFcdLine(std::string_view line, double horizon)
+{
+    if (line.substr(0, 9) == "<timestep")
+    {
+        double time;
+        NS_ABORT_MSG_UNLESS(ToDouble(Attribute(line, "time"), time),
+                            "Bad FCD timestep line: " << line);
+        if (time > horizon)
+        {
+            return false;
+        }
+        NS_ABORT_MSG_IF(time < m_timestep, "FCD timesteps must be sorted by time");
+        m_timestep = time;
+    }
+    else if (line.substr(0, 8) == "<vehicle")
+    {
+        uint32_t ue = GetUe(Attribute(line, "id"));
+        double x;
+        double y;
+        if (ue < m_numUes && ToDouble(Attribute(line, "x"), x) &&
+            ToDouble(Attribute(line, "y"), y))
+        {
+            Emit(ue, Waypoint(Seconds(m_timestep), Vector(x, y, 0.0)));
+        }
+    }
+    return true;
+}
+
+bool
+TrajectoryStreamer::ParseNs2Line(std::string_view line, double horizon)
+{
+    size_t pos = 0;
+    if (line.substr(0, 7) == "$node_(")
+    {
+        // $node_(<id>) set X_|Y_|Z_ <value>
+        uint32_t ue = GetUe(Ns2NodeId(line, pos));
+        std::string_view command = NextToken(line, pos);
+        std::string_view axis = NextToken(line, pos);
+        double value;
+        if (ue < m_numUes && command == "set" && ToDouble(NextToken(line, pos), value))
+        {
+            Vector& position = m_last[ue].position;
+            (axis == "X_" ? position.x : axis == "Y_" ? position.y : position.z) = value;
+            m_pending[ue] = true;
+        }
+        return true;
+    }
+    if (line.substr(0, 7) != "$ns_ at")
+    {
+        return true;
+    }
+
+    // $ns_ at <time> "$node_(<id>) setdest <x> <y> <speed>"
+    pos = 7;
+    double time;
+    if (!ToDouble(NextToken(line, pos), time))
+    {
+        return true;
+    }
+    if (time > horizon)
+    {
+        return false;
+    }
+    uint32_t ue = GetUe(Ns2NodeId(line, pos));
+    if (ue >= m_numUes || NextToken(line, pos) != "setdest")
+    {
+        return true;
+    }
+    double x;
+    double y;
+    double speed;
+    if (!ToDouble(NextToken(line, pos), x) || !ToDouble(NextToken(line, pos), y) ||
+        !ToDouble(NextToken(line, pos), speed))
+    {
+        return true;
+    }
+
+    if (m_pending[ue])
+    {
+        Emit(ue, m_last[ue]);
+    }
+    Waypoint& last = m_last[ue];
+    Time start = std::max(Seconds(time), last.time);
+    Vector destination(x, y, last.position.z);
+    double distance = CalculateDistance(last.position, destination);
+    Time arrival = start + (speed > 0 ? Seconds(distance / speed) : Seconds(0));
+    if (arrival <= start)
+    {
+        // Parked (speed 0) or already there: nothing moves, and WaypointMobilityModel
+        // rejects a waypoint that is not strictly later than the previous one
+        return true;
+    }
+    if (start > last.time)
+    {
+        Emit(ue, Waypoint(start, last.position));
+    }
+    Emit(ue, Waypoint(arrival, destination));
+    return true;
+}
+
+uint32_t
+TrajectoryStreamer::GetUe(std::string_view vehicle)
+{
+    if (vehicle.empty())
+    {
+        return m_numUes;
+    }
+    auto it = m_vehicleUe.find(std::string(vehicle));
+    if (it != m_vehicleUe.end())
+    {
+        return it->second;
+    }
+    if (m_vehicleUe.size() >= m_numUes)
+    {
+        return m_numUes;
+    }
+    uint32_t ue = m_vehicleUe.size();
+    m_vehicleUe.emplace(std::string(vehicle), ue);
+    return ue;
+}
+
+void
+TrajectoryStreamer::Emit(uint32_t ue, const Waypoint& waypoint)
+{
+    m_sink(ue, waypoint);
+    m_last[ue] = waypoint;
+    m_pending[ue] = false;
+    ++m_waypoints;
+}
+
+void
+TrajectoryStreamer::ReleaseConsumed()
+{
+    // Parsing never goes back: drop the fully parsed pages from the mapping
+    size_t page = sysconf(_SC_PAGESIZE);
+    size_t upTo = m_cursor / page * page;
+    if (upTo > m_released)
+    {
+        madvise(const_cast<char*>(m_data) + m_released, upTo - m_released, MADV_DONTNEED);
+        m_released = upTo;
+    }
+}
+
+} // namespace ns3
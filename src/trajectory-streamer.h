@@ -0,0 +1,112 @@
+/* trajectory-streamer.h
+ *
+ * Streams vehicular UE trajectories from a trace file (--vehicleTrace).
+ *
+ * The file is memory mapped and parsed forward only: every Lookahead / 2 of simulated
+ * time the streamer converts the records up to Now() + Lookahead into waypoints and hands
+ * them to a sink (WaypointMobilityModel::AddWaypoint or the population mobility manager),
+ * then drops the pages it has consumed. Neither the whole trajectory nor the file is ever
+ * held in memory, so multi-GB city traces cost a lookahead window of waypoints.
+ *
+ * Formats (both must be sorted by time, as SUMO writes them):
+ *  - fcd: SUMO floating car data, one element per line:
+ *        <timestep time="1.00">
+ *            <vehicle id="veh0" x="12.3" y="45.6" .../>
+ *    each vehicle line becomes a waypoint at the enclosing timestep's time
+ *  - ns2: ns-2 movement files (as written by SUMO's traceExporter or BonnMotion):
+ *        $node_(0) set X_ 12.3          initial position
+ *        $ns_ at 1.0 "$node_(0) setdest 20.0 30.0 5.0"
+ *    a setdest becomes a waypoint at its start and one at its arrival time. A setdest
+ *    issued before the previous one arrives starts when the previous one ends, one that
+ *    takes no time (speed 0 or the current position) is dropped; other "$ns_ at"
+ *    commands are ignored.
+ *
+ * Vehicles are assigned to UE indices in order of first appearance; vehicles beyond the
+ * number of UEs are ignored.
+ */
+
+#ifndef TRAJECTORY_STREAMER_H
+#define TRAJECTORY_STREAMER_H
+
+#include "ns3/callback.h"
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/waypoint.h"
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+class TrajectoryStreamer
+{
+  public:
+    enum Format
+    {
+        SUMO_FCD,
+        NS2
+    };
+
+    /// Receives (UE index, waypoint); waypoints of one UE arrive in time order
+    typedef Callback<void, uint32_t, const Waypoint&> WaypointSink;
+
+    /**
+     * \param fileName trace file
+     * \param format SUMO_FCD or NS2
+     * \param numUes UE indices available to vehicles
+     * \param sink where the waypoints go
+     * \param lookahead simulated time covered by the waypoints handed out in advance
+     */
+    TrajectoryStreamer(const std::string& fileName,
+                       Format format,
+                       uint32_t numUes,
+                       WaypointSink sink,
+                       Time lookahead);
+    ~TrajectoryStreamer();
+
+    /// Hand out the first window and schedule the refills
+    void Start();
+
+    /// Vehicles mapped to UEs so far
+    uint32_t GetVehicles() const;
+    /// Waypoints handed to the sink so far
+    uint64_t GetWaypoints() const;
+
+    /// "fcd" or "ns2"
+    static Format ParseFormat(const std::string& name);
+
+  private:
+    void Refill();
+    void Fill(double horizon);
+    /// Parse one line; false (and the line is not consumed) if it lies beyond \p horizon
+    bool ParseFcdLine(std::string_view line, double horizon);
+    bool ParseNs2Line(std::string_view line, double horizon);
+    /// UE index of a vehicle, mapping it on first sight; numUes if none is left
+    uint32_t GetUe(std::string_view vehicle);
+    void Emit(uint32_t ue, const Waypoint& waypoint);
+    void ReleaseConsumed();
+
+    Format m_format;
+    uint32_t m_numUes;
+    WaypointSink m_sink;
+    Time m_lookahead;
+
+    const char* m_data; ///< mapped file
+    size_t m_size;
+    size_t m_cursor;   ///< offset of the first unparsed line
+    size_t m_released; ///< bytes already given back to the kernel
+
+    double m_timestep; ///< fcd: time of the enclosing <timestep>
+    std::unordered_map<std::string, uint32_t> m_vehicleUe;
+    std::vector<Waypoint> m_last; ///< ns2: last waypoint of each UE
+    std::vector<bool> m_pending;  ///< ns2: m_last is an initial position not handed out yet
+    uint64_t m_waypoints;
+    EventId m_event;
+};
+
+} // namespace ns3
+
+#endif /* TRAJECTORY_STREAMER_H */
@@ -0,0 +1,413 @@
+/* trie-ipv4-routing.cc
+ *
+ * See trie-ipv4-routing.h
+ */
+
+#include "trie-ipv4-routing.h"
+
+#include "ns3/assert.h"
+#include "ns3/ipv4-route.h"
+#include "ns3/ipv4-static-routing-helper.h"
+#include "ns3/log.h"
+#include "ns3/names.h"
+#include "ns3/node.h"
+#include "ns3/output-stream-wrapper.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+NS_LOG_COMPONENT_DEFINE("TrieIpv4Routing");
+
+namespace ns3
+{
+
+NS_OBJECT_ENSURE_REGISTERED(TrieIpv4Routing);
+
+TypeId
+TrieIpv4Routing::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::TrieIpv4Routing")
+                            .SetParent<Ipv4RoutingProtocol>()
+                            .AddConstructor<TrieIpv4Routing>();
+    return tid;
+}
+
+TrieIpv4Routing::TrieIpv4Routing()
+    : m_nodes(1)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+TrieIpv4Routing::~TrieIpv4Routing()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+TrieIpv4Routing::DoDispose()
+{
+    m_ipv4 = nullptr;
+    m_routes.clear();
+    m_nodes.assign(1, TrieNode());
+    Ipv4RoutingProtocol::DoDispose();
+}
+
+void
+TrieIpv4Routing::AddNetworkRouteTo(Ipv4Address network,
+                                   Ipv4Mask mask,
+                                   Ipv4Address nextHop,
+                                   uint32_t interface,
+                                   uint32_t metric)
+{
+    NS_LOG_FUNCTION(this << network << mask << nextHop << interface << metric);
+    AddRoute({network.CombineMask(mask),
+              static_cast<uint8_t>(mask.GetPrefixLength()),
+              nextHop,
+              interface,
+              metric});
+}
+
+void
+TrieIpv4Routing::SetDefaultRoute(Ipv4Address nextHop, uint32_t interface, uint32_t metric)
+{
+    AddNetworkRouteTo(Ipv4Address::GetZero(), Ipv4Mask::GetZero(), nextHop, interface, metric);
+}
+
+void
+TrieIpv4Routing::AddRoutesFrom(Ptr<Ipv4StaticRouting> routing)
+{
+    for (uint32_t i = 0; i < routing->GetNRoutes(); ++i)
+    {
+        Ipv4RoutingTableEntry entry = routing->GetRoute(i);
+        AddNetworkRouteTo(entry.GetDestNetwork(),
+                          entry.GetDestNetworkMask(),
+                          entry.GetGateway(),
+                          entry.GetInterface(),
+                          routing->GetMetric(i));
+    }
+}
+
+uint32_t
+TrieIpv4Routing::GetNRoutes() const
+{
+    return m_routes.size();
+}
+
+Ptr<TrieIpv4Routing>
+TrieIpv4Routing::Replace(Ptr<Node> node)
+{
+    Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
+    NS_ASSERT_MSG(ipv4, "Node " << node->GetId() << " has no IPv4 stack");
+    Ipv4StaticRoutingHelper staticRoutingHelper;
+    Ptr<Ipv4StaticRouting> previous = staticRoutingHelper.GetStaticRouting(ipv4);
+    Ptr<TrieIpv4Routing> trie = CreateObject<TrieIpv4Routing>();
+    ipv4->SetRoutingProtocol(trie); // learns the connected routes
+    if (previous)
+    {
+        trie->AddRoutesFrom(previous);
+    }
+    return trie;
+}
+
+void
+TrieIpv4Routing::AddRoute(const Route& route)
+{
+    for (const Route& r : m_routes)
+    {
+        if (r.network == route.network && r.prefixLength == route.prefixLength &&
+            r.gateway == route.gateway && r.interface == route.interface)
+        {
+            return;
+        }
+    }
+    m_routes.push_back(route);
+    Insert(m_routes.size() - 1);
+}
+
+template <typename Predicate>
+void
+TrieIpv4Routing::RemoveRoutes(Predicate remove)
+{
+    m_routes.erase(std::remove_if(m_routes.begin(), m_routes.end(), remove), m_routes.end());
+    m_nodes.assign(1, TrieNode());
+    for (uint32_t i = 0; i < m_routes.size(); ++i)
+    {
+        Insert(i);
+    }
+}
+
+void
+TrieIpv4Routing::Insert(uint32_t index)
+{
+    const Route& route = m_routes[index];
+    uint32_t bits = route.network.Get();
+    uint32_t node = 0;
+    for (uint8_t depth = 0; depth < route.prefixLength; ++depth)
+    {
+        uint32_t bit = (bits >> (31 - depth)) & 1;
+        if (!m_nodes[node].child[bit])
+        {
+            m_nodes[node].child[bit] = m_nodes.size();
+            m_nodes.emplace_back(); // may move m_nodes, so index again below
+        }
+        node = m_nodes[node].child[bit];
+    }
+    std::vector<uint32_t>& routes = m_nodes[node].routes;
+    auto position = std::upper_bound(routes.begin(),
+                                     routes.end(),
+                                     route.metric,
+                                     [this](uint32_t metric, uint32_t other) {
+                                         return metric < m_routes[other].metric;
+                                     });
+    routes.insert(position, index);
+}
+
+const TrieIpv4Routing::Route*
+TrieIpv4Routing::Lookup(Ipv4Address destination, Ptr<const NetDevice> oif) const
+{
+    uint32_t bits = destination.Get();
+    const Route* best = nullptr;
+    uint32_t node = 0;
+    for (uint32_t depth = 0;; ++depth)
+    {
+        for (uint32_t index : m_nodes[node].routes)
+        {
+            const Route& route = m_routes[index];
+            if (route.interface < m_ipv4->GetNInterfaces() && m_ipv4->IsUp(route.interface) &&
+                (!oif || oif == m_ipv4->GetNetDevice(route.interface)))
+            {
+                best = &route;
+                break;
+            }
+        }
+        if (depth == 32)
+        {
+            break;
+        }
+        node = m_nodes[node].child[(bits >> (31 - depth)) & 1];
+        if (!node)
+        {
+            break;
+        }
+    }
+    return best;
+}
+
+Ptr<Ipv4Route>
+TrieIpv4Routing::MakeRoute(const Route& route, Ipv4Address destination) const
+{
+    Ptr<Ipv4Route> rtentry = Create<Ipv4Route>();
+    rtentry->SetDestination(destination);
+    Ipv4Address sourceTarget = route.gateway.IsAny() ? destination : route.gateway;
+    rtentry->SetSource(m_ipv4->SourceAddressSelection(route.interface, sourceTarget));
+    rtentry->SetGateway(route.gateway);
+    rtentry->SetOutputDevice(m_ipv4->GetNetDevice(route.interface));
+    return rtentry;
+}
+
+Ptr<Ipv4Route>
+TrieIpv4Routing::RouteOutput(Ptr<Packet> /* p */,
+                             const Ipv4Header& header,
+                             Ptr<NetDevice> oif,
+                             Socket::SocketErrno& sockerr)
+{
+    Ipv4Address destination = header.GetDestination();
+    NS_LOG_FUNCTION(this << destination << oif);
+    sockerr = Socket::ERROR_NOROUTETOHOST;
+    if (destination.IsMulticast())
+    {
+        return nullptr;
+    }
+    if (destination.IsLocalhost())
+    {
+        Ptr<Ipv4Route> rtentry = Create<Ipv4Route>();
+        rtentry->SetDestination(destination);
+        rtentry->SetGateway(Ipv4Address::GetZero());
+        rtentry->SetOutputDevice(m_ipv4->GetNetDevice(0));
+        rtentry->SetSource(Ipv4Address::GetLoopback());
+        sockerr = Socket::ERROR_NOTERROR;
+        return rtentry;
+    }
+    const Route* route = Lookup(destination, oif);
+    if (!route)
+    {
+        return nullptr;
+    }
+    sockerr = Socket::ERROR_NOTERROR;
+    return MakeRoute(*route, destination);
+}
+
+bool
+TrieIpv4Routing::RouteInput(Ptr<const Packet> p,
+                            const Ipv4Header& header,
+                            Ptr<const NetDevice> idev,
+                            const UnicastForwardCallback& ucb,
+                            const MulticastForwardCallback& /* mcb */,
+                            const LocalDeliverCallback& lcb,
+                            const ErrorCallback& ecb)
+{
+    NS_LOG_FUNCTION(this << p << header.GetDestination() << idev);
+    NS_ASSERT(m_ipv4->GetInterfaceForDevice(idev) >= 0);
+    uint32_t iif = m_ipv4->GetInterfaceForDevice(idev);
+    Ipv4Address destination = header.GetDestination();
+
+    if (m_ipv4->IsDestinationAddress(destination, iif))
+    {
+        if (lcb.IsNull())
+        {
+            return false;
+        }
+        lcb(p, header, iif);
+        return true;
+    }
+    if (destination.IsMulticast())
+    {
+        return false;
+    }
+    if (!m_ipv4->IsForwarding(iif))
+    {
+        ecb(p, header, Socket::ERROR_NOROUTETOHOST);
+        return true;
+    }
+    const Route* route = Lookup(destination, nullptr);
+    if (!route)
+    {
+        return false;
+    }
+    ucb(MakeRoute(*route, destination), p, header);
+    return true;
+}
+
+void
+TrieIpv4Routing::AddConnectedRoutes(uint32_t interface)
+{
+    for (uint32_t j = 0; j < m_ipv4->GetNAddresses(interface); ++j)
+    {
+        Ipv4InterfaceAddress address = m_ipv4->GetAddress(interface, j);
+        if (address.GetLocal() != Ipv4Address() && address.GetMask() != Ipv4Mask())
+        {
+            AddNetworkRouteTo(address.GetLocal(),
+                              address.GetMask(),
+                              Ipv4Address::GetZero(),
+                              interface);
+        }
+    }
+}
+
+void
+TrieIpv4Routing::NotifyInterfaceUp(uint32_t interface)
+{
+    NS_LOG_FUNCTION(this << interface);
+    AddConnectedRoutes(interface);
+}
+
+void
+TrieIpv4Routing::NotifyInterfaceDown(uint32_t interface)
+{
+    NS_LOG_FUNCTION(this << interface);
+    RemoveRoutes([interface](const Route& route) { return route.interface == interface; });
+}
+
+void
+TrieIpv4Routing::NotifyAddAddress(uint32_t interface, Ipv4InterfaceAddress address)
+{
+    NS_LOG_FUNCTION(this << interface << address);
+    if (m_ipv4->IsUp(interface) && address.GetLocal() != Ipv4Address() &&
+        address.GetMask() != Ipv4Mask())
+    {
+        AddNetworkRouteTo(address.GetLocal(), address.GetMask(), Ipv4Address::GetZero(), interface);
+    }
+}
+
+void
+TrieIpv4Routing::NotifyRemoveAddress(uint32_t interface, Ipv4InterfaceAddress address)
+{
+    NS_LOG_FUNCTION(this << interface << address);
+    Ipv4Address network = address.GetLocal().CombineMask(address.GetMask());
+    uint8_t prefixLength = address.GetMask().GetPrefixLength();
+    RemoveRoutes([=](const Route& route) {
+        return route.interface == interface && route.gateway.IsAny() &&
+               route.network == network && route.prefixLength == prefixLength;
+    });
+}
+
+void
+TrieIpv4Routing::SetIpv4(Ptr<Ipv4> ipv4)
+{
+    NS_LOG_FUNCTION(this << ipv4);
+    NS_ASSERT(!m_ipv4 && ipv4);
+    m_ipv4 = ipv4;
+    for (uint32_t i = 0; i < m_ipv4->GetNInterfaces(); ++i)
+    {
+        if (m_ipv4->IsUp(i))
+        {
+            AddConnectedRoutes(i);
+        }
+    }
+}
+
+void
+TrieIpv4Routing::PrintRoutingTable(Ptr<OutputStreamWrapper> stream, Time::Unit unit) const
+{
+    std::ostream* os = stream->GetStream();
+    Ptr<Node> node = m_ipv4->GetObject<Node>();
+    *os << "Node: " << node->GetId() << ", Time: " << Now().As(unit)
+        << ", Local time: " << node->GetLocalTime().As(unit) << ", TrieIpv4Routing table"
+        << std::endl;
+    *os << "Destination         Gateway         Iface  Metric" << std::endl;
+    for (const Route& route : m_routes)
+    {
+        std::ostringstream destination;
+        destination << route.network << "/" << uint32_t(route.prefixLength);
+        std::ostringstream gateway;
+        gateway << route.gateway;
+        *os << std::left << std::setw(20) << destination.str() << std::setw(16) << gateway.str()
+            << std::setw(7);
+        if (Names::FindName(m_ipv4->GetNetDevice(route.interface)).empty())
+        {
+            *os << route.interface;
+        }
+        else
+        {
+            *os << Names::FindName(m_ipv4->GetNetDevice(route.interface));
+        }
+        *os << route.metric << std::endl;
+    }
+    *os << std::right << std::endl;
+}
+
+TrieIpv4RoutingHelper::TrieIpv4RoutingHelper()
+    : m_hasDefaultRoute(false),
+      m_defaultInterface(0)
+{
+}
+
+void
+TrieIpv4RoutingHelper::SetDefaultRoute(Ipv4Address nextHop, uint32_t interface)
+{
+    m_hasDefaultRoute = true;
+    m_defaultNextHop = nextHop;
+    m_defaultInterface = interface;
+}
+
+TrieIpv4RoutingHelper*
+TrieIpv4RoutingHelper::Copy() const
+{
+    return new TrieIpv4RoutingHelper(*this);
+}
+
+Ptr<Ipv4RoutingProtocol>
+TrieIpv4RoutingHelper::Create(Ptr<Node> /* node */) const
+{
+    Ptr<TrieIpv4Routing> routing = CreateObject<TrieIpv4Routing>();
+    if (m_hasDefaultRoute)
+    {
+        // Interface indices are known before the devices exist; checked at lookup time
+        routing->SetDefaultRoute(m_defaultNextHop, m_defaultInterface);
+    }
+    return routing;
+}
+
+} // namespace ns3
@@ -0,0 +1,129 @@
+/* trie-ipv4-routing.h
+ *
+ * Longest-prefix-match unicast routing on a binary trie (--routing=trie).
+ *
+ * Ipv4StaticRouting scans its whole route list for every lookup, and the default
+ * Ipv4ListRouting in front of it asks each of its protocols in turn, so a forwarding
+ * decision grows with the table. TrieIpv4Routing keeps one trie node per prefix bit:
+ * RouteOutput / RouteInput walk at most 32 nodes from the root (the default route) and
+ * keep the deepest usable route, whatever the number of routes installed; per-UE host
+ * routes would cost the same per packet as the one 7.0.0.0/8 aggregate. Each node holds
+ * its exact prefix's routes ordered by metric; a route is usable while its interface is
+ * up and, for RouteOutput, when it leaves through the requested device.
+ *
+ * Interfaces contribute their connected routes like Ipv4StaticRouting (including the
+ * ones existing when the protocol replaces another) and going down removes every route
+ * through them. Multicast is not routed. TrieIpv4RoutingHelper installs the protocol
+ * from InternetStackHelper, optionally with a default route preset on every node, so a
+ * population of UEs needs no per-node route setup after the stack exists.
+ */
+
+#ifndef TRIE_IPV4_ROUTING_H
+#define TRIE_IPV4_ROUTING_H
+
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv4-routing-helper.h"
+#include "ns3/ipv4-routing-protocol.h"
+#include "ns3/ipv4-static-routing.h"
+#include "ns3/ipv4.h"
+
+#include <vector>
+
+namespace ns3
+{
+
+class TrieIpv4Routing : public Ipv4RoutingProtocol
+{
+  public:
+    static TypeId GetTypeId();
+
+    TrieIpv4Routing();
+    ~TrieIpv4Routing() override;
+
+    /// Route \p network / \p mask through \p interface, via \p nextHop unless it is 0.0.0.0
+    void AddNetworkRouteTo(Ipv4Address network,
+                           Ipv4Mask mask,
+                           Ipv4Address nextHop,
+                           uint32_t interface,
+                           uint32_t metric = 0);
+    void SetDefaultRoute(Ipv4Address nextHop, uint32_t interface, uint32_t metric = 0);
+    /// Copy every route of \p routing, e.g. of the protocol this one replaces
+    void AddRoutesFrom(Ptr<Ipv4StaticRouting> routing);
+    uint32_t GetNRoutes() const;
+
+    /// Replace \p node's routing protocol by a TrieIpv4Routing holding its static routes
+    static Ptr<TrieIpv4Routing> Replace(Ptr<Node> node);
+
+    Ptr<Ipv4Route> RouteOutput(Ptr<Packet> p,
+                               const Ipv4Header& header,
+                               Ptr<NetDevice> oif,
+                               Socket::SocketErrno& sockerr) override;
+    bool RouteInput(Ptr<const Packet> p,
+                    const Ipv4Header& header,
+                    Ptr<const NetDevice> idev,
+                    const UnicastForwardCallback& ucb,
+                    const MulticastForwardCallback& mcb,
+                    const LocalDeliverCallback& lcb,
+                    const ErrorCallback& ecb) override;
+    void NotifyInterfaceUp(uint32_t interface) override;
+    void NotifyInterfaceDown(uint32_t interface) override;
+    void NotifyAddAddress(uint32_t interface, Ipv4InterfaceAddress address) override;
+    void NotifyRemoveAddress(uint32_t interface, Ipv4InterfaceAddress address) override;
+    void SetIpv4(Ptr<Ipv4> ipv4) override;
+    void PrintRoutingTable(Ptr<OutputStreamWrapper> stream,
+                           Time::Unit unit = Time::S) const override;
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    struct Route
+    {
+        Ipv4Address network;
+        uint8_t prefixLength;
+        Ipv4Address gateway; ///< 0.0.0.0 = on link
+        uint32_t interface;
+        uint32_t metric;
+    };
+
+    struct TrieNode
+    {
+        uint32_t child[2] = {0, 0}; ///< 0 = none (the root is nobody's child)
+        std::vector<uint32_t> routes; ///< indices into m_routes, by increasing metric
+    };
+
+    void AddRoute(const Route& route);
+    /// Drop the routes matching \p remove and rebuild the trie
+    template <typename Predicate>
+    void RemoveRoutes(Predicate remove);
+    void Insert(uint32_t index);
+    void AddConnectedRoutes(uint32_t interface);
+    /// Deepest usable route to \p destination (through \p oif if given), nullptr if none
+    const Route* Lookup(Ipv4Address destination, Ptr<const NetDevice> oif) const;
+    Ptr<Ipv4Route> MakeRoute(const Route& route, Ipv4Address destination) const;
+
+    Ptr<Ipv4> m_ipv4;
+    std::vector<Route> m_routes;
+    std::vector<TrieNode> m_nodes; ///< m_nodes[0] is the root, prefix length 0
+};
+
+class TrieIpv4RoutingHelper : public Ipv4RoutingHelper
+{
+  public:
+    TrieIpv4RoutingHelper();
+
+    /// Give every node created from now on this default route
+    void SetDefaultRoute(Ipv4Address nextHop, uint32_t interface);
+
+    TrieIpv4RoutingHelper* Copy() const override;
+    Ptr<Ipv4RoutingProtocol> Create(Ptr<Node> node) const override;
+
+  private:
+    bool m_hasDefaultRoute;
+    Ipv4Address m_defaultNextHop;
+    uint32_t m_defaultInterface;
+};
+
+} // namespace ns3
+
+#endif /* TRIE_IPV4_ROUTING_H */
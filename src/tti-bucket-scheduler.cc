@@ -0,0 +1,235 @@
+/* tti-bucket-scheduler.cc
+ *
+ * See tti-bucket-scheduler.h
+ */
+
+#include "tti-bucket-scheduler.h"
+
+#include "ns3/abort.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+
+NS_LOG_COMPONENT_DEFINE("TtiBucketScheduler");
+
+namespace ns3
+{
+
+NS_OBJECT_ENSURE_REGISTERED(TtiBucketScheduler);
+
+TypeId
+TtiBucketScheduler::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::TtiBucketScheduler")
+            .SetParent<Scheduler>()
+            .AddConstructor<TtiBucketScheduler>()
+            .AddAttribute("BucketWidth",
+                          "Simulated time covered by one bucket",
+                          TimeValue(MilliSeconds(1)),
+                          MakeTimeAccessor(&TtiBucketScheduler::SetBucketWidth,
+                                           &TtiBucketScheduler::GetBucketWidth),
+                          MakeTimeChecker(TimeStep(1)))
+            .AddAttribute("Buckets",
+                          "Ticks in the window, the current one included",
+                          UintegerValue(1024),
+                          MakeUintegerAccessor(&TtiBucketScheduler::SetBuckets,
+                                               &TtiBucketScheduler::GetBuckets),
+                          MakeUintegerChecker<uint32_t>(2));
+    return tid;
+}
+
+TtiBucketScheduler::TtiBucketScheduler()
+    : m_width(MilliSeconds(1).GetTimeStep()),
+      m_tick(0),
+      m_bucketed(0),
+      m_size(0),
+      m_buckets(1024)
+{
+}
+
+TtiBucketScheduler::~TtiBucketScheduler()
+{
+}
+
+void
+TtiBucketScheduler::SetBucketWidth(Time width)
+{
+    NS_ABORT_MSG_UNLESS(m_size == 0, "BucketWidth cannot change while events are queued");
+    m_width = width.GetTimeStep();
+}
+
+Time
+TtiBucketScheduler::GetBucketWidth() const
+{
+    return TimeStep(m_width);
+}
+
+void
+TtiBucketScheduler::SetBuckets(uint32_t buckets)
+{
+    NS_ABORT_MSG_UNLESS(m_size == 0, "Buckets cannot change while events are queued");
+    m_buckets.assign(buckets, std::vector<Event>());
+}
+
+uint32_t
+TtiBucketScheduler::GetBuckets() const
+{
+    return m_buckets.size();
+}
+
+uint64_t
+TtiBucketScheduler::TickOf(const Event& ev) const
+{
+    return ev.key.m_ts / m_width;
+}
+
+void
+TtiBucketScheduler::Insert(const Event& ev)
+{
+    NS_LOG_FUNCTION(this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+    uint64_t tick = TickOf(ev);
+    if (tick <= m_tick)
+    {
+        m_current.push_back(ev);
+        std::push_heap(m_current.begin(), m_current.end(), Later());
+    }
+    else if (tick < m_tick + m_buckets.size())
+    {
+        m_buckets[tick % m_buckets.size()].push_back(ev);
+        ++m_bucketed;
+    }
+    else
+    {
+        m_overflow.push_back(ev);
+        std::push_heap(m_overflow.begin(), m_overflow.end(), Later());
+    }
+    ++m_size;
+    if (m_current.empty())
+    {
+        Advance();
+    }
+}
+
+bool
+TtiBucketScheduler::IsEmpty() const
+{
+    return m_size == 0;
+}
+
+Scheduler::Event
+TtiBucketScheduler::PeekNext() const
+{
+    NS_ASSERT(!m_current.empty());
+    return m_current.front();
+}
+
+Scheduler::Event
+TtiBucketScheduler::RemoveNext()
+{
+    NS_ASSERT(!m_current.empty());
+    std::pop_heap(m_current.begin(), m_current.end(), Later());
+    Event ev = m_current.back();
+    m_current.pop_back();
+    --m_size;
+    if (m_current.empty() && m_size > 0)
+    {
+        Advance();
+    }
+    NS_LOG_FUNCTION(this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+    return ev;
+}
+
+void
+TtiBucketScheduler::Remove(const Event& ev)
+{
+    NS_LOG_FUNCTION(this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+    uint64_t tick = TickOf(ev);
+    bool found;
+    if (tick <= m_tick)
+    {
+        found = RemoveFromHeap(m_current, ev.key.m_uid);
+    }
+    else if (tick < m_tick + m_buckets.size())
+    {
+        std::vector<Event>& bucket = m_buckets[tick % m_buckets.size()];
+        auto it = std::find_if(bucket.begin(), bucket.end(), [&ev](const Event& e) {
+            return e.key.m_uid == ev.key.m_uid;
+        });
+        found = it != bucket.end();
+        if (found)
+        {
+            *it = bucket.back();
+            bucket.pop_back();
+            --m_bucketed;
+        }
+    }
+    else
+    {
+        found = RemoveFromHeap(m_overflow, ev.key.m_uid);
+    }
+    NS_ASSERT_MSG(found, "Event " << ev.key.m_uid << " is not queued");
+    --m_size;
+    if (m_current.empty() && m_size > 0)
+    {
+        Advance();
+    }
+}
+
+bool
+TtiBucketScheduler::RemoveFromHeap(std::vector<Event>& heap, uint32_t uid)
+{
+    auto it = std::find_if(heap.begin(), heap.end(), [uid](const Event& e) {
+        return e.key.m_uid == uid;
+    });
+    if (it == heap.end())
+    {
+        return false;
+    }
+    *it = heap.back();
+    heap.pop_back();
+    std::make_heap(heap.begin(), heap.end(), Later());
+    return true;
+}
+
+void
+TtiBucketScheduler::PullOverflow()
+{
+    while (!m_overflow.empty() && TickOf(m_overflow.front()) < m_tick + m_buckets.size())
+    {
+        const Event& ev = m_overflow.front();
+        m_buckets[TickOf(ev) % m_buckets.size()].push_back(ev);
+        ++m_bucketed;
+        std::pop_heap(m_overflow.begin(), m_overflow.end(), Later());
+        m_overflow.pop_back();
+    }
+}
+
+void
+TtiBucketScheduler::Advance()
+{
+    NS_ASSERT(m_current.empty() && m_size > 0);
+    if (m_bucketed == 0)
+    {
+        // Nothing in the window: jump to the earliest overflow tick
+        m_tick = TickOf(m_overflow.front());
+        PullOverflow();
+    }
+    else
+    {
+        // Each step opens one tick at the end of the window, in the bucket just drained
+        do
+        {
+            ++m_tick;
+            PullOverflow();
+        } while (m_buckets[m_tick % m_buckets.size()].empty());
+    }
+    std::vector<Event>& bucket = m_buckets[m_tick % m_buckets.size()];
+    m_bucketed -= bucket.size();
+    m_current.swap(bucket); // the drained heap's capacity is reused by the bucket
+    std::make_heap(m_current.begin(), m_current.end(), Later());
+}
+
+} // namespace ns3
@@ -0,0 +1,78 @@
+/* tti-bucket-scheduler.h
+ *
+ * Calendar-style event queue tuned to the LTE 1 ms TTI (--eventQueue=tti).
+ *
+ * Time is cut into BucketWidth-wide ticks (one TTI by default). The events of the
+ * current tick, and any inserted for a tick already passed, sit in a binary min-heap;
+ * the next Buckets - 1 ticks each have an unsorted bucket, so scheduling into the next
+ * TTIs, the bulk of what the PHY / MAC / RLC do, is an O(1) append and the bucket is
+ * heapified in O(k) only when its tick becomes current. Events beyond the window (RLC
+ * and TCP timers, application starts) wait in a separate overflow heap and move into
+ * their bucket once the window reaches them; when every bucket is empty the window
+ * jumps straight to the earliest overflow event instead of stepping over idle TTIs.
+ * Remove() is a linear search of one bucket or heap: ns-3 mostly cancels events, which
+ * stay queued, and rarely removes them.
+ *
+ * Order is the usual (timestamp, uid), so runs are identical to the other backends.
+ */
+
+#ifndef TTI_BUCKET_SCHEDULER_H
+#define TTI_BUCKET_SCHEDULER_H
+
+#include "ns3/nstime.h"
+#include "ns3/scheduler.h"
+
+#include <vector>
+
+namespace ns3
+{
+
+class TtiBucketScheduler : public Scheduler
+{
+  public:
+    static TypeId GetTypeId();
+
+    TtiBucketScheduler();
+    ~TtiBucketScheduler() override;
+
+    void Insert(const Event& ev) override;
+    bool IsEmpty() const override;
+    Event PeekNext() const override;
+    Event RemoveNext() override;
+    void Remove(const Event& ev) override;
+
+  private:
+    /// Heap order: the earliest event on top
+    struct Later
+    {
+        bool operator()(const Event& a, const Event& b) const
+        {
+            return b < a;
+        }
+    };
+
+    void SetBucketWidth(Time width);
+    Time GetBucketWidth() const;
+    void SetBuckets(uint32_t buckets);
+    uint32_t GetBuckets() const;
+
+    uint64_t TickOf(const Event& ev) const;
+    /// Move the overflow events that fall inside the window into their bucket
+    void PullOverflow();
+    /// With the current heap empty, make the next non-empty tick current
+    void Advance();
+    /// Erase the event with \p uid from the heap \p heap; false if it is not there
+    static bool RemoveFromHeap(std::vector<Event>& heap, uint32_t uid);
+
+    uint64_t m_width;     ///< bucket width in time steps
+    uint64_t m_tick;      ///< tick of the current heap
+    uint64_t m_bucketed;  ///< events in m_buckets
+    uint64_t m_size;      ///< all queued events
+    std::vector<Event> m_current;
+    std::vector<std::vector<Event>> m_buckets; ///< tick t at t % size, for t in the window
+    std::vector<Event> m_overflow;             ///< heap of the events beyond the window
+};
+
+} // namespace ns3
+
+#endif /* TTI_BUCKET_SCHEDULER_H */
@@ -0,0 +1,229 @@
+/* web-session-application.cc
+ *
+ * See web-session-application.h
+ */
+
+#include "web-session-application.h"
+
+#include "ns3/log.h"
+#include "ns3/packet.h"
+#include "ns3/pointer.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+#include <cmath>
+
+NS_LOG_COMPONENT_DEFINE("WebSessionApplication");
+
+namespace ns3
+{
+
+NS_OBJECT_ENSURE_REGISTERED(WebSessionApplication);
+
+TypeId
+WebSessionApplication::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::WebSessionApplication")
+            .SetParent<Application>()
+            .AddConstructor<WebSessionApplication>()
+            .AddAttribute("Remote",
+                          "Destination address of the UDP packets",
+                          AddressValue(),
+                          MakeAddressAccessor(&WebSessionApplication::m_remote),
+                          MakeAddressChecker())
+            .AddAttribute("DataRate",
+                          "Rate at which the packets of an object are paced",
+                          DataRateValue(DataRate("5Mbps")),
+                          MakeDataRateAccessor(&WebSessionApplication::m_rate),
+                          MakeDataRateChecker())
+            .AddAttribute("PacketSize",
+                          "UDP payload bytes per packet",
+                          UintegerValue(1024),
+                          MakeUintegerAccessor(&WebSessionApplication::m_packetSize),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("TrainPackets",
+                          "Maximum packets sent by one event",
+                          UintegerValue(16),
+                          MakeUintegerAccessor(&WebSessionApplication::m_trainPackets),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("MainObjectSize",
+                          "Size in bytes of a page's main object",
+                          StringValue("ns3::LogNormalRandomVariable[Mu=8.37|Sigma=1.37]"),
+                          MakePointerAccessor(&WebSessionApplication::m_mainObjectSize),
+                          MakePointerChecker<RandomVariableStream>())
+            .AddAttribute("EmbeddedObjectSize",
+                          "Size in bytes of an embedded object",
+                          StringValue("ns3::LogNormalRandomVariable[Mu=6.17|Sigma=2.36]"),
+                          MakePointerAccessor(&WebSessionApplication::m_embeddedObjectSize),
+                          MakePointerChecker<RandomVariableStream>())
+            .AddAttribute("EmbeddedObjectCount",
+                          "Embedded objects per page plus 2 (3GPP: Pareto, k=2, alpha=1.1, m=55)",
+                          StringValue("ns3::ParetoRandomVariable[Scale=2|Shape=1.1|Bound=55]"),
+                          MakePointerAccessor(&WebSessionApplication::m_embeddedObjectCount),
+                          MakePointerChecker<RandomVariableStream>())
+            .AddAttribute("ParsingTime",
+                          "Seconds between the main object and the embedded objects",
+                          StringValue("ns3::ExponentialRandomVariable[Mean=0.13]"),
+                          MakePointerAccessor(&WebSessionApplication::m_parsingTime),
+                          MakePointerChecker<RandomVariableStream>())
+            .AddAttribute("ReadingTime",
+                          "Seconds between the end of a page and the next page",
+                          StringValue("ns3::ExponentialRandomVariable[Mean=5]"),
+                          MakePointerAccessor(&WebSessionApplication::m_readingTime),
+                          MakePointerChecker<RandomVariableStream>())
+            .AddAttribute("MaxObjectSize",
+                          "Object sizes are truncated to this many bytes",
+                          UintegerValue(2000000),
+                          MakeUintegerAccessor(&WebSessionApplication::m_maxObjectSize),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddTraceSource("Tx",
+                            "A packet has been sent",
+                            MakeTraceSourceAccessor(&WebSessionApplication::m_txTrace),
+                            "ns3::Packet::TracedCallback");
+    return tid;
+}
+
+WebSessionApplication::WebSessionApplication()
+    : m_objectBytesLeft(0),
+      m_embeddedLeft(0),
+      m_mainObject(false),
+      m_pages(0),
+      m_totalTx(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+WebSessionApplication::~WebSessionApplication()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+int64_t
+WebSessionApplication::AssignStreams(int64_t stream)
+{
+    m_mainObjectSize->SetStream(stream);
+    m_embeddedObjectSize->SetStream(stream + 1);
+    m_embeddedObjectCount->SetStream(stream + 2);
+    m_parsingTime->SetStream(stream + 3);
+    m_readingTime->SetStream(stream + 4);
+    return 5;
+}
+
+uint32_t
+WebSessionApplication::GetPages() const
+{
+    return m_pages;
+}
+
+uint64_t
+WebSessionApplication::GetTotalTx() const
+{
+    return m_totalTx;
+}
+
+void
+WebSessionApplication::DoDispose()
+{
+    m_socket = nullptr;
+    Application::DoDispose();
+}
+
+void
+WebSessionApplication::StartApplication()
+{
+    NS_LOG_FUNCTION(this);
+    if (!m_socket)
+    {
+        m_socket = Socket::CreateSocket(GetNode(), UdpSocketFactory::GetTypeId());
+        m_socket->Bind();
+        m_socket->Connect(m_remote);
+        m_socket->ShutdownRecv();
+    }
+    StartPage();
+}
+
+void
+WebSessionApplication::StopApplication()
+{
+    NS_LOG_FUNCTION(this);
+    Simulator::Cancel(m_event);
+    if (m_socket)
+    {
+        m_socket->Close();
+    }
+}
+
+void
+WebSessionApplication::StartPage()
+{
+    ++m_pages;
+    double embedded = std::floor(m_embeddedObjectCount->GetValue()) - 2.0;
+    m_embeddedLeft = static_cast<uint32_t>(std::max(0.0, embedded));
+    m_mainObject = true;
+    NS_LOG_LOGIC("page " << m_pages << " with " << m_embeddedLeft << " embedded objects");
+    StartObject(static_cast<uint32_t>(m_mainObjectSize->GetValue()));
+}
+
+void
+WebSessionApplication::StartObject(uint32_t bytes)
+{
+    m_objectBytesLeft = std::min(std::max(bytes, 1U), m_maxObjectSize);
+    SendTrain();
+}
+
+void
+WebSessionApplication::SendTrain()
+{
+    uint32_t sentBytes = 0;
+    for (uint32_t n = 0; n < m_trainPackets && m_objectBytesLeft > 0; ++n)
+    {
+        uint32_t size = std::min(m_packetSize, m_objectBytesLeft);
+        Ptr<Packet> packet = Create<Packet>(size);
+        m_txTrace(packet);
+        m_socket->Send(packet);
+        m_objectBytesLeft -= size;
+        sentBytes += size;
+    }
+    m_totalTx += sentBytes;
+
+    Time trainTime = m_rate.CalculateBytesTxTime(sentBytes);
+    if (m_objectBytesLeft > 0)
+    {
+        m_event = Simulator::Schedule(trainTime, &WebSessionApplication::SendTrain, this);
+    }
+    else
+    {
+        m_event = Simulator::Schedule(trainTime, &WebSessionApplication::ObjectDone, this);
+    }
+}
+
+void
+WebSessionApplication::ObjectDone()
+{
+    if (m_embeddedLeft == 0)
+    {
+        // End of the page: read it, then fetch the next one
+        m_event = Simulator::Schedule(Seconds(m_readingTime->GetValue()),
+                                      &WebSessionApplication::StartPage,
+                                      this);
+        return;
+    }
+
+    Time pause = Seconds(0);
+    if (m_mainObject)
+    {
+        pause = Seconds(m_parsingTime->GetValue());
+        m_mainObject = false;
+    }
+    --m_embeddedLeft;
+    m_event = Simulator::Schedule(pause,
+                                  &WebSessionApplication::StartObject,
+                                  this,
+                                  static_cast<uint32_t>(m_embeddedObjectSize->GetValue()));
+}
+
+} // namespace ns3
@@ -0,0 +1,81 @@
+/* web-session-application.h
+ *
+ * Web browsing source, used in place of the always-on OnOff flows (--webModel=session).
+ *
+ * Each page is a main object, a parsing pause and a number of embedded objects, followed
+ * by a reading pause before the next page; object sizes, object count and the pauses are
+ * drawn from RandomVariableStream attributes whose defaults follow the 3GPP HTTP traffic
+ * model (truncated lognormal sizes, truncated Pareto object count), with a shorter reading
+ * time so a 20 s run sees several pages.
+ *
+ * Objects are sent over UDP as packet trains: one event sends up to TrainPackets packets
+ * back to back and the next train is scheduled after the train's transmission time at
+ * DataRate, instead of one event per packet as in OnOffApplication.
+ */
+
+#ifndef WEB_SESSION_APPLICATION_H
+#define WEB_SESSION_APPLICATION_H
+
+#include "ns3/address.h"
+#include "ns3/application.h"
+#include "ns3/data-rate.h"
+#include "ns3/event-id.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/socket.h"
+#include "ns3/traced-callback.h"
+
+namespace ns3
+{
+
+class WebSessionApplication : public Application
+{
+  public:
+    static TypeId GetTypeId();
+
+    WebSessionApplication();
+    ~WebSessionApplication() override;
+
+    int64_t AssignStreams(int64_t stream) override;
+
+    /// Pages started so far
+    uint32_t GetPages() const;
+    /// Bytes handed to the socket so far
+    uint64_t GetTotalTx() const;
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    void StartApplication() override;
+    void StopApplication() override;
+
+    void StartPage();
+    void StartObject(uint32_t bytes);
+    void SendTrain();
+    void ObjectDone();
+
+    Address m_remote;
+    Ptr<Socket> m_socket;
+    DataRate m_rate;
+    uint32_t m_packetSize;
+    uint32_t m_trainPackets;
+    Ptr<RandomVariableStream> m_mainObjectSize;
+    Ptr<RandomVariableStream> m_embeddedObjectSize;
+    Ptr<RandomVariableStream> m_embeddedObjectCount;
+    Ptr<RandomVariableStream> m_parsingTime;
+    Ptr<RandomVariableStream> m_readingTime;
+    uint32_t m_maxObjectSize;
+
+    uint32_t m_objectBytesLeft;
+    uint32_t m_embeddedLeft;
+    bool m_mainObject; ///< the object being sent is the page's main object
+    uint32_t m_pages;
+    uint64_t m_totalTx;
+    EventId m_event;
+
+    TracedCallback<Ptr<const Packet>> m_txTrace;
+};
+
+} // namespace ns3
+
+#endif /* WEB_SESSION_APPLICATION_H */